@@ -11,7 +11,8 @@ template_string = """cc_library(
     name = "source",
     srcs = [{% for file in src_files %}"src/{{ file }}.cpp"{% if not loop.last %}, {% endif %}{% endfor %}], 
     hdrs = [{% for file in hdr_files %}"inc/{{ file }}.h"{% if not loop.last %}, {% endif %}{% endfor %}], 
-    includes = ["inc"]
+    includes = ["inc"],
+    linkopts = ["-pthread"]
 )
 
 {% for test_file in test_files %}
@@ -26,21 +27,35 @@ cc_test(
     ]
 )
 {% endfor %}
+{% for bench_file in bench_files %}
+cc_binary(
+    name = "{{ bench_file }}", 
+    srcs = ["benchmarks/{{ bench_file }}.cc"], 
+    deps = [
+        ":source",
+        "@google_benchmark//:{% if bench_file in bench_with_main %}benchmark{% else %}benchmark_main{% endif %}"
+    ]
+)
+{% endfor %}
 """
 
 # Directories
 src_directory = 'src'
 inc_directory = 'inc'
 tests_directory = 'tests'
+benchmarks_directory = 'benchmarks'
 
 # Get lists of files
 src_files = get_files_from_directory(src_directory)
 hdr_files = get_files_from_directory(inc_directory)
 test_files = get_files_from_directory(tests_directory)
+bench_files = get_files_from_directory(benchmarks_directory)
+# Benchmarks that define their own main, such as a regression gate, link the library without benchmark_main
+bench_with_main = [f for f in bench_files if 'int main(' in open(os.path.join(benchmarks_directory, f + '.cc')).read()]
 
 # Create a Jinja Template object and render the content
 template = Template(template_string)
-output = template.render(src_files=src_files, hdr_files=hdr_files, test_files=test_files)
+output = template.render(src_files=src_files, hdr_files=hdr_files, test_files=test_files, bench_files=bench_files, bench_with_main=bench_with_main)
 
 # Write the generated content to a file
 output_file = 'BUILD'  # You can change the filename as needed
@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+#include "Matrix.h"
+#include "common.h"
+
+// Compares the cofactor expansion inverse of the general Matrix against the closed form
+// and affine Matrix4 inverses. Run with --benchmark_format=json to export the results
+
+// General(non-affine) 4x4 matrix used by the benchmarks
+static Matrix4 generalMatrix(){
+    std::vector<std::vector<float>> v = {{-5, 2, 6, -8}, {1, -5, 1, 8}, {7, 7, -6, -7}, {1, -3, 7, 4}};
+    return Matrix(4, 4, v);
+}
+
+// Typical object transform, rotation + scaling + translation
+static Matrix4 affineMatrix(){
+    return chainTransformationMatrices({yRotationMatrix(PI/5), scalingMatrix(2, 0.5, 3), translationMatrix(1.5, -2, 4)});
+}
+
+static void BM_MatrixCofactorInverse(benchmark::State& state){
+    Matrix m = generalMatrix();
+    for(auto _ : state){
+        benchmark::DoNotOptimize(m.inverse());
+    }
+}
+BENCHMARK(BM_MatrixCofactorInverse);
+
+static void BM_Matrix4ClosedFormInverse(benchmark::State& state){
+    Matrix4 m = generalMatrix();
+    for(auto _ : state){
+        benchmark::DoNotOptimize(m.inverse());
+    }
+}
+BENCHMARK(BM_Matrix4ClosedFormInverse);
+
+static void BM_MatrixCofactorInverseAffine(benchmark::State& state){
+    Matrix m = affineMatrix();
+    for(auto _ : state){
+        benchmark::DoNotOptimize(m.inverse());
+    }
+}
+BENCHMARK(BM_MatrixCofactorInverseAffine);
+
+static void BM_Matrix4AffineInverse(benchmark::State& state){
+    Matrix4 m = affineMatrix();
+    for(auto _ : state){
+        benchmark::DoNotOptimize(m.inverse());
+    }
+}
+BENCHMARK(BM_Matrix4AffineInverse);
@@ -0,0 +1,320 @@
+#include <benchmark/benchmark.h>
+#include "Matrix.h"
+#include "Ray.h"
+#include "Shape.h"
+#include "Group.h"
+#include "Triangle.h"
+#include "ObjParser.h"
+#include "Pattern.h"
+#include "Canvas.h"
+#include "LightAndShading.h"
+#include "LightData.h"
+#include "Intersection.h"
+#include "common.h"
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+// Microbenchmarks of the kernels the renderer spends its time in. Export the results with
+//   bazel run -c opt :micro_bench -- --benchmark_out=micro.json --benchmark_out_format=json
+// or "make bench_json BENCH=micro_bench" so runs before and after a change can be compared with
+// the compare.py tool that ships with Google Benchmark
+
+// Typical object transform, rotation + scaling + translation
+static Matrix4 objectTransform(){
+    return chainTransformationMatrices({yRotationMatrix(PI/5), scalingMatrix(2, 0.5, 3), translationMatrix(1.5, -2, 4)});
+}
+
+// Ray that hits every default shape at the origin
+static Ray centreRay(){
+    return Ray(Point(0.1, 0.2, -5), Vector(0, 0, 1));
+}
+
+static void BM_MatrixInverse(benchmark::State& state){
+    Matrix m = objectTransform();
+    for(auto _ : state){
+        benchmark::DoNotOptimize(m.inverse());
+    }
+}
+BENCHMARK(BM_MatrixInverse);
+
+static void BM_Matrix4Inverse(benchmark::State& state){
+    Matrix4 m = objectTransform();
+    for(auto _ : state){
+        benchmark::DoNotOptimize(m.inverse());
+    }
+}
+BENCHMARK(BM_Matrix4Inverse);
+
+static void BM_MatrixMultiply(benchmark::State& state){
+    Matrix a = objectTransform();
+    Matrix b = xRotationMatrix(PI/3);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(a*b);
+    }
+}
+BENCHMARK(BM_MatrixMultiply);
+
+static void BM_Matrix4Multiply(benchmark::State& state){
+    Matrix4 a = objectTransform();
+    Matrix4 b = xRotationMatrix(PI/3);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(a*b);
+    }
+}
+BENCHMARK(BM_Matrix4Multiply);
+
+static void BM_Matrix4TupleMultiply(benchmark::State& state){
+    Matrix4 a = objectTransform();
+    Tuple t = Point(1, 2, 3);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(a*t);
+    }
+}
+BENCHMARK(BM_Matrix4TupleMultiply);
+
+static void BM_RayTransform(benchmark::State& state){
+    Matrix4 m = objectTransform().inverse();
+    Ray r = centreRay();
+    for(auto _ : state){
+        benchmark::DoNotOptimize(r.transform(m));
+    }
+}
+BENCHMARK(BM_RayTransform);
+
+// Runs the shape's intersection kernel on a ray in object space, reusing one buffer like the renderer does
+static void benchmarkChildIntersections(benchmark::State& state, Shape &s){
+    Ray r = centreRay();
+    std::vector<Intersection> intersects;
+    for(auto _ : state){
+        intersects.clear();
+        s.childIntersections(r, intersects);
+        benchmark::DoNotOptimize(intersects.data());
+    }
+}
+
+static void BM_SphereIntersections(benchmark::State& state){
+    Sphere s;
+    benchmarkChildIntersections(state, s);
+}
+BENCHMARK(BM_SphereIntersections);
+
+static void BM_PlaneIntersections(benchmark::State& state){
+    Plane s;
+    Ray r(Point(0, 1, -5), Vector(0, -0.5, 1).normalize());
+    std::vector<Intersection> intersects;
+    for(auto _ : state){
+        intersects.clear();
+        s.childIntersections(r, intersects);
+        benchmark::DoNotOptimize(intersects.data());
+    }
+}
+BENCHMARK(BM_PlaneIntersections);
+
+static void BM_CubeIntersections(benchmark::State& state){
+    Cube s;
+    benchmarkChildIntersections(state, s);
+}
+BENCHMARK(BM_CubeIntersections);
+
+static void BM_CylinderIntersections(benchmark::State& state){
+    Cylinder s;
+    s.setMinH(-1);
+    s.setMaxH(1);
+    s.setClosed(true);
+    benchmarkChildIntersections(state, s);
+}
+BENCHMARK(BM_CylinderIntersections);
+
+static void BM_ConeIntersections(benchmark::State& state){
+    Cone s;
+    s.setMinH(-1);
+    s.setMaxH(1);
+    s.setClosed(true);
+    benchmarkChildIntersections(state, s);
+}
+BENCHMARK(BM_ConeIntersections);
+
+static void BM_TriangleIntersections(benchmark::State& state){
+    Triangle s(Point(0, 1, 0), Point(-1, -1, 0), Point(1, -1, 0));
+    benchmarkChildIntersections(state, s);
+}
+BENCHMARK(BM_TriangleIntersections);
+
+// Mesh of state.range(0) x state.range(0) squares, two triangles each, over the unit square around the origin
+static void BM_TriangleMeshIntersections(benchmark::State& state){
+    int side = state.range(0);
+    std::vector<Point> vertices;
+    for(int y = 0; y <= side; y++){
+        for(int x = 0; x <= side; x++){
+            vertices.push_back(Point(-1 + 2.0*x/side, -1 + 2.0*y/side, 0.1*((x + y) % 3)));
+        }
+    }
+    std::vector<uint32_t> indices;
+    for(int y = 0; y < side; y++){
+        for(int x = 0; x < side; x++){
+            uint32_t a = y*(side + 1) + x;
+            uint32_t c = a + side + 1;
+            indices.insert(indices.end(), {a, a + 1, c + 1, a, c + 1, c});
+        }
+    }
+    TriangleMesh mesh(vertices, indices);
+    benchmarkChildIntersections(state, mesh);
+}
+BENCHMARK(BM_TriangleMeshIntersections)->Arg(4)->Arg(64)->Arg(512);
+
+// Parses an OBJ grid of about 500k triangles with state.range(0) threads
+static void BM_ObjParser(benchmark::State& state){
+    static std::string text;
+    int side = 500;
+    if(text.empty()){
+        std::ostringstream out;
+        for(int y = 0; y <= side; y++){
+            for(int x = 0; x <= side; x++){
+                out << "v " << x*0.01 << " " << y*0.01 << " " << (x*y % 7)*0.125 << "\n";
+            }
+        }
+        out << "g grid\n";
+        for(int y = 0; y < side; y++){
+            for(int x = 0; x < side; x++){
+                int a = y*(side + 1) + x + 1;
+                out << "f " << a << " " << a + 1 << " " << a + side + 2 << " " << a + side + 1 << "\n";
+            }
+        }
+        text = out.str();
+    }
+
+    for(auto _ : state){
+        ObjParser parser(text, state.range(0));
+        benchmark::DoNotOptimize(parser.getVertices().data());
+    }
+    state.SetBytesProcessed(state.iterations()*text.size());
+}
+BENCHMARK(BM_ObjParser)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Group of state.range(0) spheres spread along the ray so every child is tested
+static void BM_GroupIntersections(benchmark::State& state){
+    Group g;
+    std::vector<Sphere> spheres(state.range(0));
+    for(int i = 0; i < spheres.size(); i++){
+        spheres.at(i).setTransform(translationMatrix(0, 0, 3*i));
+        g.appendShape(&spheres.at(i));
+    }
+    benchmarkChildIntersections(state, g);
+}
+BENCHMARK(BM_GroupIntersections)->Arg(1)->Arg(8)->Arg(64);
+
+static void BM_ComputeLighting(benchmark::State& state){
+    Sphere s;
+    Material m;
+    LightSource l(Point(-10, 10, -10), Colour(1, 1, 1));
+    Point p(0, 0, -1);
+    Vector camera(0, 0, -1);
+    Vector normal = s.computeNormal(p);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(computeLighting(m, &s, l, p, camera, normal, false));
+    }
+}
+BENCHMARK(BM_ComputeLighting);
+
+static void BM_PrepareLightData(benchmark::State& state){
+    Sphere s;
+    Ray r = centreRay();
+    std::vector<Intersection> intersects = s.findIntersections(r);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(prepareLightData(intersects.at(0), r, intersects));
+    }
+}
+BENCHMARK(BM_PrepareLightData);
+
+// Ray through state.range(0) nested glass spheres, the refractive indices are found at the innermost hit
+static void BM_FindRefractiveIndices(benchmark::State& state){
+    int n = state.range(0);
+    std::vector<Sphere> spheres(n);
+    std::vector<Intersection> intersects;
+    Ray r = centreRay();
+    for(int i = 0; i < n; i++){
+        float scale = n - i;
+        spheres.at(i).setTransform(scalingMatrix(scale, scale, scale));
+        Material m;
+        m.transparency = 1;
+        m.refractiveIndex = 1 + 0.1*i;
+        spheres.at(i).setMaterial(m);
+        spheres.at(i).findIntersections(r, intersects);
+    }
+    std::sort(intersects.begin(), intersects.end(), compareIntersections);
+    Intersection hit = intersects.at(n - 1);
+
+    for(auto _ : state){
+        LightData data;
+        findRefractiveIndices(data, hit, intersects);
+        benchmark::DoNotOptimize(data.n1);
+    }
+}
+BENCHMARK(BM_FindRefractiveIndices)->Arg(2)->Arg(8)->Arg(32);
+
+static void benchmarkPattern(benchmark::State& state, Pattern &p){
+    Point point(0.3, 1.7, -2.2);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(p.ChildApplyPattern(point));
+    }
+}
+
+static void BM_StripesPattern(benchmark::State& state){
+    Stripes p;
+    benchmarkPattern(state, p);
+}
+BENCHMARK(BM_StripesPattern);
+
+static void BM_LinearGradientPattern(benchmark::State& state){
+    LinearGradient p;
+    benchmarkPattern(state, p);
+}
+BENCHMARK(BM_LinearGradientPattern);
+
+static void BM_RingPattern(benchmark::State& state){
+    RingPattern p;
+    benchmarkPattern(state, p);
+}
+BENCHMARK(BM_RingPattern);
+
+static void BM_CheckerPattern(benchmark::State& state){
+    CheckerPattern p;
+    benchmarkPattern(state, p);
+}
+BENCHMARK(BM_CheckerPattern);
+
+// Square canvas of state.range(0) pixels per side filled with a gradient so every number has to be formatted
+static void BM_CanvasToPPM(benchmark::State& state){
+    int size = state.range(0);
+    Canvas c(size, size);
+    for(int y = 0; y < size; y++){
+        for(int x = 0; x < size; x++){
+            c.write_pixel(x, y, Colour(1.0*x/size, 1.0*y/size, 0.5));
+        }
+    }
+
+    for(auto _ : state){
+        benchmark::DoNotOptimize(c.toPPM());
+    }
+    state.SetItemsProcessed(state.iterations()*size*size);
+}
+BENCHMARK(BM_CanvasToPPM)->Arg(64)->Arg(256)->Arg(2048)->Unit(benchmark::kMillisecond);
+
+static void BM_CanvasWriteP6(benchmark::State& state){
+    int size = state.range(0);
+    Canvas c(size, size);
+    for(int y = 0; y < size; y++){
+        for(int x = 0; x < size; x++){
+            c.write_pixel(x, y, Colour(1.0*x/size, 1.0*y/size, 0.5));
+        }
+    }
+
+    for(auto _ : state){
+        std::ostringstream out;
+        c.writeP6(out);
+        benchmark::DoNotOptimize(out.str().size());
+    }
+    state.SetItemsProcessed(state.iterations()*size*size);
+}
+BENCHMARK(BM_CanvasWriteP6)->Arg(64)->Arg(256);
@@ -0,0 +1,203 @@
+#include <benchmark/benchmark.h>
+#include "Scenes.h"
+#include "Camera.h"
+#include "Canvas.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <stdexcept>
+
+// End to end render benchmark and regression gate. Renders each scene with Camera::renderParallel
+// and reports ms per frame(the Time column) and primary rays per second. The rays per second of every
+// scene are compared with the baseline file and the run exits with 1 if any scene is slower than
+// baseline*(1 - tolerance), or if a scene has no baseline or a baseline scene didn't run.
+// Invalid flags or a missing or malformed baseline file exit with 2 before anything is run.
+//   bazel run -c opt :scene_bench                                  run and check against the baseline
+//   bazel run -c opt :scene_bench -- --tolerance=0.05              allow at most a 5% drop
+//   bazel run -c opt :scene_bench -- --update_baseline             record this machine's results
+//   bazel run -c opt :scene_bench -- --baseline=other.txt          use a different baseline file
+// Baselines only make sense on the machine they were recorded on, regenerate the file with
+// --update_baseline on the release machine before using it as a gate
+
+static const char* DEFAULT_BASELINE = "benchmarks/baselines/scene_bench.txt";
+static const double DEFAULT_TOLERANCE = 0.10;
+static const char* RAYS_COUNTER = "rays_per_second";
+
+// Renders one frame of the scene per iteration, renderParallel rebuilds the BVH each frame so the
+// build is included like it is for a real render
+static void renderScene(benchmark::State& state, Scene scene){
+    int pixels = scene.camera.getHSize()*scene.camera.getVSize();
+    for(auto _ : state){
+        Canvas c = scene.camera.renderParallel(scene.world);
+        benchmark::DoNotOptimize(c);
+    }
+    state.counters[RAYS_COUNTER] = benchmark::Counter(1.0*pixels*state.iterations(), benchmark::Counter::kIsRate);
+}
+
+static void BM_MainScene(benchmark::State& state){
+    renderScene(state, mainScene(400, 200));
+}
+BENCHMARK(BM_MainScene)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_DefaultScene(benchmark::State& state){
+    renderScene(state, defaultScene(200, 200));
+}
+BENCHMARK(BM_DefaultScene)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_GlassScene(benchmark::State& state){
+    renderScene(state, glassScene(200, 200));
+}
+BENCHMARK(BM_GlassScene)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_StressScene(benchmark::State& state){
+    renderScene(state, stressScene(1000, 200, 200));
+}
+BENCHMARK(BM_StressScene)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Console reporter that also keeps the rays per second of every run for the gate
+class GateReporter : public benchmark::ConsoleReporter{
+public:
+    std::map<std::string, double> raysPerSecond;
+
+    void ReportRuns(const std::vector<Run>& runs) override{
+        for(int i = 0; i < runs.size(); i++){
+            auto counter = runs.at(i).counters.find(RAYS_COUNTER);
+            if(runs.at(i).run_type == Run::RT_Iteration && counter != runs.at(i).counters.end()){
+                raysPerSecond[runs.at(i).benchmark_name()] = counter->second.value;
+            }
+        }
+        ConsoleReporter::ReportRuns(runs);
+    }
+};
+
+// bazel run starts the binary in the runfiles tree, relative paths are resolved from the workspace instead
+static std::string workspacePath(std::string path){
+    const char* workspace = std::getenv("BUILD_WORKSPACE_DIRECTORY");
+    if(workspace == nullptr || path.empty() || path.at(0) == '/'){
+        return path;
+    }
+    return std::string(workspace) + "/" + path;
+}
+
+// Parses the whole of s as a finite number, returns false if anything else is in it
+static bool parseNumber(const char* s, double &value){
+    char* end;
+    value = std::strtod(s, &end);
+    return end != s && *end == '\0' && std::isfinite(value);
+}
+
+// Reads "benchmark_name rays_per_second" lines, lines starting with # are comments
+static std::map<std::string, double> readBaseline(std::string path){
+    std::map<std::string, double> baseline;
+    std::ifstream f(path);
+    if(!f.is_open()){
+        throw std::invalid_argument("readBaseline: cannot open " + path + ", record one with --update_baseline");
+    }
+    std::string line;
+    while(std::getline(f, line)){
+        if(line.empty() || line.at(0) == '#'){
+            continue;
+        }
+        size_t split = line.find_last_of(' ');
+        if(split == std::string::npos){
+            throw std::invalid_argument("readBaseline: invalid line \"" + line + "\" in " + path);
+        }
+        double raysPerSecond;
+        if(!parseNumber(line.c_str() + split + 1, raysPerSecond) || raysPerSecond <= 0){
+            throw std::invalid_argument("readBaseline: invalid rays per second in line \"" + line + "\" in " + path);
+        }
+        baseline[line.substr(0, split)] = raysPerSecond;
+    }
+
+    return baseline;
+}
+
+static void writeBaseline(std::string path, std::map<std::string, double> raysPerSecond){
+    std::ofstream f(path);
+    f << "# Primary rays per second of each scene_bench scene, regenerate with --update_baseline\n";
+    for(auto &entry : raysPerSecond){
+        f << entry.first << " " << static_cast<long long>(entry.second) << "\n";
+    }
+}
+
+int main(int argc, char** argv){
+    // A filtered run only checks the scenes it ran, Initialize removes the flag so it is looked for first
+    bool filtered = false;
+    for(int i = 1; i < argc; i++){
+        filtered = filtered || std::strncmp(argv[i], "--benchmark_filter=", 19) == 0;
+    }
+    benchmark::Initialize(&argc, argv);
+
+    std::string baselinePath = DEFAULT_BASELINE;
+    double tolerance = DEFAULT_TOLERANCE;
+    bool updateBaseline = false;
+    for(int i = 1; i < argc; i++){
+        if(std::strncmp(argv[i], "--baseline=", 11) == 0){
+            baselinePath = argv[i] + 11;
+        }else if(std::strncmp(argv[i], "--tolerance=", 12) == 0){
+            if(!parseNumber(argv[i] + 12, tolerance) || tolerance < 0 || tolerance > 1){
+                std::cerr << "scene_bench: --tolerance must be a number from 0 to 1, got " << argv[i] + 12 << "\n";
+                return 2;
+            }
+        }else if(std::strcmp(argv[i], "--update_baseline") == 0){
+            updateBaseline = true;
+        }else{
+            std::cerr << "scene_bench: unknown flag " << argv[i] << "\n";
+            return 2;
+        }
+    }
+    baselinePath = workspacePath(baselinePath);
+
+    // The baseline is read before the benchmarks run so a missing or malformed file fails straight away
+    std::map<std::string, double> baseline;
+    if(!updateBaseline){
+        try{
+            baseline = readBaseline(baselinePath);
+        }catch(const std::invalid_argument &e){
+            std::cerr << "scene_bench: " << e.what() << "\n";
+            return 2;
+        }
+    }
+
+    GateReporter reporter;
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    benchmark::Shutdown();
+
+    if(updateBaseline){
+        writeBaseline(baselinePath, reporter.raysPerSecond);
+        std::cout << "Wrote baseline " << baselinePath << "\n";
+        return 0;
+    }
+
+    bool passed = true;
+    for(auto &entry : reporter.raysPerSecond){
+        auto expected = baseline.find(entry.first);
+        if(expected == baseline.end()){
+            passed = false;
+            std::cout << "FAIL " << entry.first << " has no baseline, record one with --update_baseline\n";
+            continue;
+        }
+
+        double change = entry.second/expected->second - 1;
+        bool ok = change >= -tolerance;
+        passed = passed && ok;
+        std::cout << (ok ? "OK   " : "FAIL ") << entry.first << " " << static_cast<long long>(entry.second)
+            << " rays/s, baseline " << static_cast<long long>(expected->second) << " (" << change*100 << "%)\n";
+    }
+
+    // A scene in the baseline that didn't run was renamed or removed, the baseline has to be updated with it
+    for(auto &entry : baseline){
+        if(!filtered && reporter.raysPerSecond.find(entry.first) == reporter.raysPerSecond.end()){
+            passed = false;
+            std::cout << "FAIL " << entry.first << " is in the baseline but didn't run\n";
+        }
+    }
+
+    std::cout << (passed ? "Scene benchmark gate passed" : "Scene benchmark gate failed") << " with tolerance "
+        << tolerance*100 << "%\n";
+    return passed ? 0 : 1;
+}
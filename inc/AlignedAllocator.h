@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <new>
+
+// Size of a cache line on the x86 and ARM processors the renderer targets
+const size_t CACHE_LINE_SIZE = 64;
+
+// Allocator for std::vector that starts the storage on an Alignment byte boundary. Used for large
+// buffers that are split between threads so a thread's range starts on its own cache line
+template <typename T, size_t Alignment = CACHE_LINE_SIZE>
+class AlignedAllocator{
+public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind{
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator() noexcept{}
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept{}
+
+    T* allocate(size_t n){
+        return static_cast<T*>(::operator new(n*sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept{
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+};
+
+template <typename T, typename U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&){
+    return true;
+}
+
+template <typename T, typename U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&){
+    return false;
+}
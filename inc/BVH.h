@@ -0,0 +1,67 @@
+#pragma once
+#include "Shape.h"
+#include "BoundingBox.h"
+#include "PrimitiveStore.h"
+#include "Intersection.h"
+#include "Ray.h"
+#include <vector>
+
+// Bounding volume hierarchy over a list of shapes. Shapes are grouped into a binary tree of bounding
+// boxes so a ray only has to be tested against the shapes whose boxes it passes through. The tree is
+// split using the surface area heuristic(SAH), which estimates the cost of a split as the surface area
+// of each child box(proportional to the chance a ray hits it) times the number of shapes inside it.
+// Shapes with infinite bounds(eg. planes) can't be placed in the tree and are always tested.
+// Shapes are bounded and intersected in world space through their committed world matrices, so the
+// tree can hold primitives from inside groups(see Shape::commitTransforms)
+class BVH{
+private:
+    // Node of the tree. Leaf nodes store a range [start, start + count) of the shapes vector,
+    // interior nodes store the indices of their two children in the nodes vector
+    struct Node{
+        BoundingBox bounds;
+        int left;
+        int right;
+        int start;
+        int count;
+    };
+
+    std::vector<Node> nodes;
+    // Bounded shapes, reordered during the build so each leaf's shapes are contiguous
+    std::vector<Shape*> shapes;
+    // Bounds of each shape in the shapes vector
+    std::vector<BoundingBox> shapeBounds;
+    // Shapes with infinite bounds
+    std::vector<Shape*> unbounded;
+    // Typed copies of shapes followed by unbounded, used by the traversals instead of the shape pointers
+    PrimitiveStore store;
+
+    // Recursively builds the node containing shapes [start, end) at the given depth, returns the index of the node
+    int buildNode(int start, int end, int depth);
+public:
+    // Maximum number of shapes in a leaf, leaves are only made larger if no split is cheaper
+    static const int MAX_LEAF_SIZE = 4;
+    // Number of buckets the centroids are sorted into when searching for the cheapest split
+    static const int SAH_BUCKETS = 12;
+    // Maximum depth of the tree, bounds the size of the traversal stack
+    static const int MAX_DEPTH = 48;
+
+    // BVH constructors, the default BVH is empty
+    BVH();
+    BVH(const std::vector<Shape*> &objects);
+
+    // Getters
+    int getNodeCount() const;
+    const std::vector<Shape*>& getUnbounded() const;
+    const PrimitiveStore& getPrimitiveStore() const;
+    // Bounds of all bounded shapes in the tree
+    BoundingBox getBounds() const;
+
+    // Appends the intersections of r with every shape whose bounds the ray passes through at a time in
+    // [tMin, tMax] to intersects. The intersections are not sorted
+    void intersect(const Ray &r, std::vector<Intersection> &intersects, float tMin = -INFINITY, float tMax = INFINITY) const;
+    // Finds the intersection with the lowest time in [tMin, tMax). Nodes that the ray only enters after
+    // the closest hit found so far are skipped. Returns false if there is no intersection
+    bool closestHit(const Ray &r, Intersection &hit, float tMin = 0, float tMax = INFINITY) const;
+    // Checks if any shape that casts shadows is hit at a time in (tMin, tMax), stops at the first one found
+    bool occluded(const Ray &r, float tMin, float tMax) const;
+};
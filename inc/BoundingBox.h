@@ -0,0 +1,51 @@
+#pragma once
+#include "Tuple.h"
+#include "Matrix.h"
+#include "Ray.h"
+#include "common.h"
+#include <cmath>
+#include <algorithm>
+
+// Axis aligned bounding box, stores the minimum and maximum corner of the box.
+// Used to skip intersection tests for rays that cannot hit the shapes inside the box.
+// Components can be infinite for unbounded shapes(eg. planes, uncapped cylinders)
+class BoundingBox{
+private:
+    Point minimum;
+    Point maximum;
+public:
+    // BoundingBox constructors, the default box is empty(contains no points)
+    BoundingBox();
+    BoundingBox(const Point &min, const Point &max);
+
+    // Getters
+    const Point& getMin() const;
+    const Point& getMax() const;
+
+    // Checks if the box contains no points
+    bool isEmpty() const;
+    // Checks if every component of the box is finite
+    bool isFinite() const;
+
+    // Grows the box to contain the point p or the box b
+    void addPoint(const Point &p);
+    void merge(const BoundingBox &b);
+    // Grows the box by distance d in every direction
+    void pad(float d);
+
+    // Returns the box containing this box after it is transformed by m
+    // A box with infinite components transforms to the box containing all of space
+    BoundingBox transform(const Matrix4 &m) const;
+
+    // Center of the box and surface area, used by the BVH to decide how to split shapes
+    Point centroid() const;
+    float surfaceArea() const;
+
+    // Checks if the ray r passes through the box at a time in [tMin, tMax]
+    bool intersects(const Ray &r, float tMin = -INFINITY, float tMax = INFINITY) const;
+    // Same as intersects but also sets tEnter to the first time in [tMin, tMax] that the ray is inside the box
+    bool intersects(const Ray &r, float tMin, float tMax, float &tEnter) const;
+};
+
+// Box containing all of space, used for shapes without finite bounds
+BoundingBox infiniteBoundingBox();
@@ -3,7 +3,10 @@
 #include "Ray.h"
 #include "Canvas.h"
 #include "World.h"
+#include "ThreadPool.h"
+#include "Config.h"
 #include <stdexcept>
+#include "RenderStats.h"
 
 // Class representing a virtual camera that you are able to move around the world.
 // Actually, moving the world relative to the camera by multiplying the inverse of
@@ -25,27 +28,34 @@ private:
     // if we wanted to compute the position of the camera, we would
     // multiply inverse(transform)*Point(0, 0, 0) assuming default camera
     // starts at origin
-    Matrix transform;
+    Matrix4 transform;
+    // Inverse of transform, recomputed by setTransform so rayToPixel doesn't invert per pixel
+    Matrix4 inverseTransform;
 public:
     // Camera constructor
     Camera(int h, int v, float fov);
 
     // Camera getters
-    int getHSize();
-    int getVSize();
-    float getFOV();
-    Matrix getTransform();
-    float getPixelSize();
+    int getHSize() const;
+    int getVSize() const;
+    float getFOV() const;
+    const Matrix4& getTransform() const;
+    const Matrix4& getInverseTransform() const;
+    float getPixelSize() const;
 
     // Camera setters
-    void setTransform(Matrix m);
+    void setTransform(const Matrix4 &m);
 
     // Computes pixel size in world units
     void computePixelSize();
 
     // Computes a ray that starts at the camera and goes through the canvas at the specified xy pixel
-    Ray rayToPixel(int x, int y);
+    Ray rayToPixel(int x, int y) const;
 
     // Produces the rendered canvas for the given world based off of the camera and world properties
-    Canvas render(World w);
+    // The world is not copied, only its BVH is rebuilt before rendering
+    Canvas render(World &w) const;
+    // Same as render but the canvas is split into tiles that are rendered over a work stealing thread pool
+    // Each pixel is identical to the render result. A thread count below 1 uses every hardware thread
+    Canvas renderParallel(World &w, int threads = RENDER_THREADS) const;
 };
\ No newline at end of file
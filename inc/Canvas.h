@@ -5,17 +5,53 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include "RenderStats.h"
+#include "AlignedAllocator.h"
+#include <stdexcept>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include "ThreadPool.h"
+#include "Config.h"
 
 const int DEFAULT_WIDTH = 100;
 const int DEFAULT_HEIGHT = 100;
 
+// Longest line allowed in a P3 file
+const int PPM_LINE_LIMIT = 70;
+// Most characters a pixel can take in a P3 file, three 3 digit values each with a separator
+const int PPM_MAX_CHARS_PER_PIXEL = 12;
+// Number of rows formatted by each task when the P3 output is built in parallel
+const int PPM_ROWS_PER_TASK = 16;
+
+// Non owning view of consecutive pixels in a canvas, the C++17 stand in for std::span<Colour>.
+// Lets render threads and image writers work on the canvas memory without copying it.
+// The accessors are defined in the header so they compile down to plain loads and stores
+class ColourSpan{
+private:
+    Colour* first;
+    int length;
+public:
+    ColourSpan(Colour* p, int n) : first(p), length(n){}
+
+    Colour* data(){ return first; }
+    int size(){ return length; }
+    Colour* begin(){ return first; }
+    Colour* end(){ return first + length; }
+    // Unchecked, i must be in [0, size())
+    Colour& operator[](int i){ return first[i]; }
+};
+
 // Class to render and modify generated images
 class Canvas{
 private:
     // Width and height of canvas
     int width, height;
-    // 2D array storing the colour properties of each pixel
-    std::vector<std::vector<Colour>> pixels;
+    // Number of pixels between the start of one row and the next
+    int stride;
+    // Colour of every pixel stored row by row in one cache line aligned buffer, pixel (x, y) is at y*stride + x
+    std::vector<Colour, AlignedAllocator<Colour>> pixels;
 public:
     // Canvas constructors and destructor
     Canvas();
@@ -24,11 +60,47 @@ public:
     // Getters and setters
     int getWidth();
     int getHeight();
+    int getStride();
+    // Bounds checked, throws if xy is outside the canvas
     Colour pixelColour(int x, int y);
+    // Writes outside the canvas are ignored
     void write_pixel(int x, int y, Colour c);
     void setAllPixels(Colour c);
 
-    // Produces the canvas as a ppm file string
-    std::string toPPM();
+    // Unchecked accessor for internal loops that already know xy is inside the canvas
+    Colour& pixel(int x, int y){ return pixels[y*stride + x]; }
+    // View of row y
+    ColourSpan row(int y);
+    // View of every pixel in the canvas, rows follow each other with no padding
+    ColourSpan pixelSpan();
+
+    // Produces the canvas as a ppm file string, formatting the rows over threads(a thread count below 1
+    // uses every hardware thread)
+    std::string toPPM(int threads = RENDER_THREADS);
     void writeToFile(std::string file_name);
-};
\ No newline at end of file
+
+    // Streams the canvas as a binary P6 ppm, one row at a time through a row sized buffer. Channels
+    // take 1 byte when maxval <= 255 and 2 big endian bytes when maxval is up to 65535
+    void writeP6(std::ostream &out, int maxval = 255);
+    void writeP6ToFile(std::string file_name, int maxval = 255);
+
+    // Float image formats that keep colours outside [0, 1] so a render can be tone mapped again later
+    // Portable float map, 32 bit float channels written straight from the pixel buffer in host byte order
+    void writePFM(std::ostream &out);
+    void writePFMToFile(std::string file_name);
+    // Radiance .hdr, shared exponent RGBE pixels with each scanline run length encoded
+    void writeHDR(std::ostream &out);
+    void writeHDRToFile(std::string file_name);
+};
+
+// Formats one row of pixels as P3 text into out, returns the number of characters written
+int formatPPMRow(ColourSpan line, char* out);
+
+// Packs a colour into Radiance RGBE, three 8 bit mantissas sharing the exponent in the fourth byte
+void colourToRGBE(Colour c, unsigned char rgbe[4]);
+// Run length encodes n bytes of one RGBE component the way Radiance scanlines store them, appends to out
+// and returns the number of bytes written. out must hold at least n + (n + 127)/128 bytes
+int encodeRGBERun(const unsigned char* data, int n, unsigned char* out);
+
+// Converts a colour channel to an integer in [0, maxval], rounding up like the P3 output does
+int quantizeChannel(float c, int maxval = 255);
\ No newline at end of file
@@ -8,13 +8,13 @@ public:
     float r, g, b;
     Colour();
     Colour(float r, float g, float b);
-    bool isEqual(Colour a);
+    bool isEqual(const Colour &a) const;
 
     // Colour operations
-    Colour operator+(Colour a);
-    Colour operator-(Colour a);
-    Colour operator*(Colour a);
-    Colour operator*(float scale);
+    Colour operator+(const Colour &a) const;
+    Colour operator-(const Colour &a) const;
+    Colour operator*(const Colour &a) const;
+    Colour operator*(float scale) const;
 };
 
 // Colour constants
@@ -6,4 +6,9 @@ const bool RENDER_SHADOWS = true;
 
 // TODO: PATTERNS, REFLECTION, TRANSPARENCY, REFRACTION
 
-const int RECURSIVE_REFLECT_LIMIT = 4;
\ No newline at end of file
+const int RECURSIVE_REFLECT_LIMIT = 4;
+
+// Number of threads used by Camera::renderParallel, 0 uses every hardware thread
+const int RENDER_THREADS = 0;
+// Side length in pixels of the square tiles that Camera::renderParallel splits the image into
+const int RENDER_TILE_SIZE = 16;
\ No newline at end of file
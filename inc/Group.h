@@ -10,9 +10,16 @@ private:
     // Stores all shapes contained in the group
     std::vector<Shape*> shapes;
 public:
-    std::vector<Shape*> getShapes();
+    const std::vector<Shape*>& getShapes() const;
     void appendShape(Shape* s);
 
-    // Shape override function
-    std::vector<Intersection> childIntersections(Ray r);
+    // Shape override functions
+    using Shape::childIntersections;
+    void childIntersections(const Ray &r, std::vector<Intersection> &intersects);
+    // Box containing the bounds of every shape in the group
+    BoundingBox childBounds();
+    // Commits the group's world matrices and then its children, the group itself is not a primitive
+    void commitTransforms(const Matrix4 &parentTransform, const Matrix4 &parentInverse, std::vector<Shape*> &primitives);
+    // Invalidates the group and every shape below it, their world matrices all include the group's transform
+    void invalidateWorldTransforms();
 };
\ No newline at end of file
@@ -7,17 +7,21 @@ class Intersection{
     private:
         // Stores time and sphere that a ray intersected
         float time;
+        // Index of the part of the shape that was hit(the triangle of a mesh), -1 for shapes without parts
+        // Fits in the padding between time and s so it doesn't make intersections any larger
+        int index;
         Shape* s;
     public:
         // Intersection constructor
-        Intersection(float t, Shape* s);
+        Intersection(float t, Shape* s, int index = -1);
 
         // Getters for Intersection variables
-        float getTime();
-        Shape* getShape();
+        float getTime() const;
+        Shape* getShape() const;
+        int getIndex() const;
 
         // Equality check
-        bool isEqual(Intersection i);
+        bool isEqual(const Intersection &i) const;
 };
 
 // Function to pack a list of intersections into a vector
@@ -26,7 +30,7 @@ std::vector<Intersection> intersections(std::initializer_list<Intersection> l);
 // Takes a list of intersections and identifies the index of the first object that
 // the ray hits in the list of objects. The object that is hit is the object with 
 // the lowest non-negative time
-int hit(std::vector<Intersection> vec);
+int hit(const std::vector<Intersection> &vec);
 
 // Intersection comparison function
-bool compareIntersections(Intersection a, Intersection b);
+bool compareIntersections(const Intersection &a, const Intersection &b);
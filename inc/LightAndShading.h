@@ -11,7 +11,7 @@
 // the normal vector at that point. Computes the resulting vector 
 // that would be produced when the input vector reflects or bounces
 // off of the surface
-Vector reflectVector(Vector input, Vector normal);
+Vector reflectVector(const Vector &input, const Vector &normal);
 
 // Class representing a light source originating from a single point
 class LightSource{
@@ -23,14 +23,14 @@ private:
 public:
     // Lightsource constructors
     LightSource();
-    LightSource(Point p, Colour i);
+    LightSource(const Point &p, const Colour &i);
 
     // Variable getters
-    Point getPosition();
-    Colour getIntensity();
+    const Point& getPosition() const;
+    const Colour& getIntensity() const;
 
     // Equality function
-    bool isEqual(LightSource l);
+    bool isEqual(const LightSource &l) const;
 };
 
 // Class representing a material and storing attributes for the Phong
@@ -59,10 +59,10 @@ public:
     Material();
 
     // Equality function
-    bool isEqual(Material m);
+    bool isEqual(const Material &m) const;
 };
 
 // Performs lighting computations. Takes the material, the point that is being lit,
 // the light source, camera vector, and normal vector as input parameters.
 // Also, considers if the point has a shadow casted on it by another object
-Colour computeLighting(Material m, Shape* object, LightSource l, Point p, Vector camera, Vector normal, bool inShadow);
\ No newline at end of file
+Colour computeLighting(const Material &m, Shape* object, const LightSource &l, const Point &p, const Vector &camera, const Vector &normal, bool inShadow);
\ No newline at end of file
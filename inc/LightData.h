@@ -6,11 +6,14 @@
 #include "LightAndShading.h"
 #include "Colour.h"
 #include <vector>
+#include "RenderStats.h"
 
-// Class to store computeLighting parameter data
+// Class to store computeLighting parameter data. A plain hit record that lives on the stack of the
+// caller, the secondary fields(reflect, underPoint, n1 and n2) are only filled in by prepareLightData
+// when the hit object's material is reflective or transparent, otherwise they keep their defaults
 class LightData{
 public:
-    // Object being hit
+    // Object being hit, nullptr until the data is prepared for a hit
     Shape* object;
     // Time at which object is hit
     float time;
@@ -20,26 +23,35 @@ public:
     // Overpoint is offset a fraction above the surface
     // This is used so the renderer doesn't think a point casts a point on itself due to bit error
     Point overPoint;
-    // Underpoint is offset a fraction below the surface
+    // Underpoint is offset a fraction below the surface, only set for transparent materials
     Point underPoint;
     // Vector pointing from the point to the camera
     Vector camera;
     // Normal vector at the point
     Vector normal;
-    // Reflection vector of the ray on the point
+    // Reflection vector of the ray on the point, only set for reflective materials
     Vector reflect;
     // Boolean for whether the ray is inside the object before it hit the object
     bool insideObject;
     // Floats corresponding to the refractive index of the material being exited(n1) and entered(n2)
+    // Only set for transparent materials
     float n1, n2;
     
     LightData();
 };
 
+// Object the ray entered while findRefractiveIndices walks the intersections, the refractive index is
+// copied from its material when the object is entered. inside is cleared when the ray leaves the object
+struct RefractiveContainer{
+    Shape* shape;
+    float refractiveIndex;
+    bool inside;
+};
+
 // Takes an intersection and ray and prepares them for computeLighting function
 // The rayIntersects vector stores all the intersections of the ray passed in to prepare refraction data
-LightData prepareLightData(Intersection i, Ray r, std::vector<Intersection> rayIntersects = std::vector<Intersection>());
-void findRefractiveIndices(LightData &data, Intersection i, std::vector<Intersection> rayIntersects = std::vector<Intersection>());
+LightData prepareLightData(const Intersection &i, const Ray &r, const std::vector<Intersection> &rayIntersects = std::vector<Intersection>());
+void findRefractiveIndices(LightData &data, const Intersection &i, const std::vector<Intersection> &rayIntersects = std::vector<Intersection>());
 // Approximating Fresnel Effect using Schlick's approximation to find the reflectance which represents the fraction of light 
 // that is reflected, used
-float schlickApproximation(LightData data);
\ No newline at end of file
+float schlickApproximation(const LightData &data);
\ No newline at end of file
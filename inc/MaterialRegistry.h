@@ -0,0 +1,76 @@
+#pragma once
+#include "LightAndShading.h"
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// Compact handle to a material in a MaterialRegistry
+typedef int MaterialID;
+
+// ID of the default Material(), every registry starts with it and it is never released
+const MaterialID DEFAULT_MATERIAL = 0;
+
+// Table of materials that shapes refer to by ID, so thousands of shapes sharing a few materials
+// store one copy of each instead of one per shape, and editing a registered material changes every
+// shape that uses it. Materials are stored in a deque so references returned by get stay valid when
+// more are added.
+// A slot stays in use while it is registered or a shape uses it. add registers a material and release
+// drops that registration, each shape using a slot holds a reference that is dropped when the shape
+// stops using it. Materials a shape registers for itself with Shape::setMaterial are never registered,
+// so they can only be released by the shape and can't be shared through setMaterialID.
+// Every function except get holds the registry's mutex, so shapes can be created, copied, given materials
+// and destroyed on several threads at once. get is called for every shaded hit and doesn't lock, it must not
+// run while another thread adds or releases materials, which doesn't happen while rendering. Code that may
+// run alongside such changes reads materials with copy
+class MaterialRegistry{
+private:
+    // Bookkeeping of a slot, registered is true from add until release and shapes counts the shapes
+    // using the slot
+    struct Slot{
+        bool registered;
+        int shapes;
+    };
+
+    std::deque<Material> materials;
+    std::vector<Slot> slots;
+    // Released IDs that add reuses before growing the table
+    std::vector<MaterialID> freeIDs;
+    mutable std::mutex lock;
+
+    // Used by shapes to reference slots, so outside code can't release a slot a shape uses
+    friend class Shape;
+    // Adds a material used only by the shape calling it, the slot starts with the shape's reference
+    MaterialID addForShape(const Material &m);
+    // Adds a reference from a shape to a slot in use, throws if the slot is free
+    void retain(MaterialID id);
+    // Drops a shape's reference and frees the slot if it was the last use, never throws
+    void releaseForShape(MaterialID id);
+
+    // Helpers for callers that already hold the lock
+    MaterialID addLocked(const Material &m, const Slot &slot);
+    bool inUseLocked(MaterialID id) const;
+    void freeIfUnusedLocked(MaterialID id);
+public:
+    // Registry constructor, contains only the default material
+    MaterialRegistry();
+
+    // Adds a copy of the material and returns its ID, the material stays registered until it is released
+    MaterialID add(const Material &m);
+    // Returns the material with the ID, valid while the ID is in use
+    const Material& get(MaterialID id) const;
+    // Returns a copy of the material with the ID, read while holding the lock
+    Material copy(MaterialID id) const;
+    // Replaces the material with the ID, every shape using it sees the change
+    void set(MaterialID id, const Material &m);
+    // Drops the registration of a material from add. Shapes still using it keep it until they stop, its ID
+    // can no longer be given to shapes. The default material can't be released
+    void release(MaterialID id);
+    // Number of materials in use, including the default material
+    int size() const;
+    // Checks if the ID refers to a registered material, which can be given to shapes with setMaterialID
+    bool contains(MaterialID id) const;
+};
+
+// Registry used by every shape. Shared materials are registered here and assigned to shapes with
+// Shape::setMaterialID, Shape::setMaterial registers a material owned by that shape
+MaterialRegistry& materialRegistry();
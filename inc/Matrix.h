@@ -5,10 +5,14 @@
 #include "Tuple.h"
 #include <string>
 #include <cmath>
+#include "RenderStats.h"
 
 const int DEFAULT_ROWS = 4;
 const int DEFAULT_COLS = 4;
 
+class Matrix4; // forward declaration
+
+// General NxM matrix. Used for matrix math that is not a 4x4 transform(eg. submatrices, column vectors)
 class Matrix{
     private:
         int rows;
@@ -20,60 +24,103 @@ class Matrix{
         Matrix(int i);
         Matrix(int r, int c);
         Matrix(int r, int c, std::vector<std::vector<float>> vec);
+        // Converts a fixed size 4x4 matrix to a general matrix
+        Matrix(const Matrix4 &m);
 
         // Checks if given coordinates are valid
-        bool checkCoordValid(int x, int y);
+        bool checkCoordValid(int x, int y) const;
 
         // Getters and setters for variables
-        int getRows();
-        int getCols();
-        float getElement(int x, int y);
+        int getRows() const;
+        int getCols() const;
+        float getElement(int x, int y) const;
         void setElement(int x, int y, float val);
-        std::vector<std::vector<float>> getMatrix();
+        const std::vector<std::vector<float>>& getMatrix() const;
 
-        std::string toString();
+        std::string toString() const;
 
         // Equality check function
-        bool isEqual(Matrix a);
+        bool isEqual(const Matrix &a) const;
 
         // Matrix operations
         // Transpose of matrix
-        Matrix transpose();
+        Matrix transpose() const;
         // Determinant for 2x2 matrix
-        float twoDet();
+        float twoDet() const;
         // Returns a submatrix with row x and col y removed
-        Matrix submatrix(int x, int y);
+        Matrix submatrix(int x, int y) const;
         // Calculates the minor of the matrix given xy(More info in Matrix.cpp)
-        float minor(int x, int y);
+        float minor(int x, int y) const;
         // Calculates the cofactor of the matrix given xy(More info in Matrix.cpp)
-        float cofactor(int x, int y);
+        float cofactor(int x, int y) const;
         // Calculates the determinant
-        float determinant();
+        float determinant() const;
         // Checks if matrix is invertable
-        bool isInvertable();
+        bool isInvertable() const;
         // Computes inverse of matrix
-        Matrix inverse();
+        Matrix inverse() const;
+
+        Matrix operator*(const Matrix &m2) const;
+        Tuple operator*(const Tuple &m2) const;
+};
+
+// Fixed size 4x4 matrix used for all transforms. The elements are stored contiguously
+// in the object itself, so creating, copying and multiplying these never allocates
+class Matrix4{
+    private:
+        alignas(16) float matrix[4][4];
+    public:
+        // Constructors, default constructor creates the 4x4 identity matrix
+        Matrix4();
+        // Converts a general matrix to a 4x4 matrix, throws if m is not 4x4
+        Matrix4(const Matrix &m);
+
+        // Checks if given coordinates are valid
+        bool checkCoordValid(int x, int y) const;
+
+        // Getters and setters for elements
+        float getElement(int x, int y) const;
+        void setElement(int x, int y, float val);
+
+        std::string toString() const;
+
+        // Equality check function
+        bool isEqual(const Matrix4 &a) const;
+
+        // Matrix operations
+        // Transpose of matrix
+        Matrix4 transpose() const;
+        // Calculates the determinant
+        float determinant() const;
+        // Checks if matrix is invertable
+        bool isInvertable() const;
+        // Checks if the bottom row of the matrix is 0, 0, 0, 1
+        bool isAffine() const;
+        // Computes inverse of matrix, uses inverseAffine when the matrix is affine
+        Matrix4 inverse() const;
+        // Computes inverse of an affine matrix by inverting the 3x3 part and the translation directly
+        Matrix4 inverseAffine() const;
 
-        Matrix operator*(Matrix m2);
-        Tuple operator*(Tuple m2);
+        Matrix4 operator*(const Matrix4 &m2) const;
+        Tuple operator*(const Tuple &m2) const;
 };
 
 // Matrix transformations
 // Generates a translation matrix given x, y, z coordinates
-Matrix translationMatrix(float x, float y, float z);
+Matrix4 translationMatrix(float x, float y, float z);
 // Generates a scaling matrix given x, y, z coordinates
-Matrix scalingMatrix(float x, float y, float z);
+Matrix4 scalingMatrix(float x, float y, float z);
 // Basic Rotations, rotates r radians around the specified axis in the function
-Matrix xRotationMatrix(float r);
-Matrix yRotationMatrix(float r);
-Matrix zRotationMatrix(float r);
+Matrix4 xRotationMatrix(float r);
+Matrix4 yRotationMatrix(float r);
+Matrix4 zRotationMatrix(float r);
 // Shearing matrix, x_y = x moved in proportion to y
-Matrix shearingMatrix(float x_y, float x_z, float y_x, float y_z, float z_x, float z_y);
+Matrix4 shearingMatrix(float x_y, float x_z, float y_x, float y_z, float z_x, float z_y);
 // Chaining transformations, input the matrix transformations as parameters to produce
 // a matrix that performs all transformations at once when multiplied
-Matrix chainTransformationMatrices(std::initializer_list<Matrix> matrices);
+Matrix4 chainTransformationMatrices(std::initializer_list<Matrix4> matrices);
 // View transformation matrix. Moves the world relative to the camera. Intuitively, you can think of it as moving
 //  the "camera" around the world to view it from different positions/directions. The cameraPosition parameter is the 
 // point where the camera is located. The to parameter is where the camera is looking. The up parameter specifies 
 // which direction is pointing upwards from the camera
-Matrix viewTransformationMatrix(Point cameraPosition, Point to, Vector up);
\ No newline at end of file
+Matrix4 viewTransformationMatrix(const Point &cameraPosition, const Point &to, const Vector &up);
\ No newline at end of file
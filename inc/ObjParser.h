@@ -0,0 +1,77 @@
+#pragma once
+#include "Group.h"
+#include "Triangle.h"
+#include "Tuple.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Faces of one group of an OBJ file, as triangles indexing the file's vertex buffer
+struct ObjGroup{
+    // Name given by the file's "g" line, empty for the default group faces belong to before any "g" line
+    std::string name;
+    // Three 0 based vertex indices per triangle, faces with more than 3 vertices are split into a fan
+    std::vector<uint32_t> indices;
+};
+
+// Groups and meshes built from an OBJ file. The model owns all of them and deletes them with the model, so
+// it must outlive any world its root is added to. A model can be moved but not copied
+class ObjModel{
+private:
+    // shapes[0] is the root
+    std::vector<std::unique_ptr<Shape>> shapes;
+
+    // Takes ownership of s and appends it to parent, a group of the model
+    friend class ObjParser;
+    void append(Group* parent, Shape* s);
+public:
+    // Model constructor, holds only an empty root group
+    ObjModel();
+
+    // Group holding the meshes and groups of the file, valid while the model is
+    Group* getRoot() const;
+};
+
+// Parser for Wavefront OBJ files. Reads "v" vertices, "vn" normals, "f" faces and "g" groups, faces may be
+// written as v, v/vt, v//vn or v/vt/vn and negative indices count back from the last vertex read. Every
+// other line is counted as ignored.
+// The text is split into chunks on line boundaries and the chunks are parsed in parallel on a ThreadPool
+// with std::from_chars. Each chunk keeps its own buffers, once every chunk is parsed the vertex offsets of
+// the chunks are known, and the chunks copy their buffers straight into their place in the final buffers
+// in parallel as well. Relative indices are fixed up in that pass
+class ObjParser{
+private:
+    std::vector<Point> vertices;
+    std::vector<Vector> normals;
+    // groups[0] is the default group, named groups follow in the order they first appear. A name used by
+    // several "g" lines is one group
+    std::vector<ObjGroup> groups;
+    int ignoredLines = 0;
+public:
+    // Smallest chunk a thread is given, smaller files are parsed by fewer threads
+    static const size_t MIN_CHUNK_SIZE = 1 << 16;
+    // Chunks per thread, extra chunks let the pool balance threads that get slower chunks
+    static const int CHUNKS_PER_THREAD = 4;
+
+    // Parses size bytes of OBJ text, a thread count below 1 uses the number of hardware threads.
+    // Throws if a vertex, normal or face can't be read or a face refers to a vertex that doesn't exist
+    ObjParser(const char* data, size_t size, int threads = 0);
+    ObjParser(const std::string &text, int threads = 0);
+
+    // Getters
+    const std::vector<Point>& getVertices() const;
+    const std::vector<Vector>& getNormals() const;
+    const std::vector<ObjGroup>& getGroups() const;
+    int getIgnoredLines() const;
+
+    // Builds a model whose root holds a TriangleMesh of the default group's faces and a child Group with a
+    // TriangleMesh for each named group, in the order of getGroups(). Groups without faces get no mesh.
+    // The vertex buffer is moved into the mesh when only one group has faces, otherwise each mesh gets
+    // the vertices its group uses. The parser is empty afterwards
+    ObjModel toModel();
+};
+
+// Maps the file into memory and parses it, throws if the file can't be opened
+ObjParser parseObjFile(const std::string &path, int threads = 0);
@@ -9,15 +9,22 @@ class Shape; // forward declaration of shape
 // Parent class for patterns. Children will be custom patterns that can be applied to objects
 // The transform is used to manipulate the pattern on objects(eg. make it larger, rotate it)
 class Pattern{
+protected:
+    Matrix4 transform = Matrix4();
+    // Inverse of transform, recomputed by setTransform
+    Matrix4 inverseTransform = Matrix4();
 public:
     std::vector<Colour> colours = std::vector<Colour>({WHITE, BLACK});
-    Matrix transform = Matrix(4);
 
-    Matrix getTransform();
-    void setTransform(Matrix m);
+    // Patterns are deleted through Pattern pointers(eg. by the Scene that owns them)
+    virtual ~Pattern() = default;
 
-    Colour applyPattern(Shape* s, Point p);
-    virtual Colour ChildApplyPattern(Point p);
+    const Matrix4& getTransform() const;
+    void setTransform(const Matrix4 &m);
+    const Matrix4& getInverseTransform() const;
+
+    Colour applyPattern(Shape* s, const Point &p) const;
+    virtual Colour ChildApplyPattern(const Point &p) const;
 };
 
 class Stripes : public Pattern{
@@ -26,7 +33,7 @@ public:
     Stripes(std::initializer_list<Colour> colours);
 
     // Pattern override
-    Colour ChildApplyPattern(Point p);
+    Colour ChildApplyPattern(const Point &p) const;
 };
 
 class LinearGradient : public Pattern{
@@ -35,7 +42,7 @@ public:
     LinearGradient(std::initializer_list<Colour> colours);
 
     // Pattern override
-    Colour ChildApplyPattern(Point p);
+    Colour ChildApplyPattern(const Point &p) const;
 };
 
 // Depends on x and z value, think of a archery target
@@ -45,7 +52,7 @@ public:
     RingPattern(std::initializer_list<Colour> colours);
 
     // Pattern override
-    Colour ChildApplyPattern(Point p);
+    Colour ChildApplyPattern(const Point &p) const;
 };
 
 // Depends on x, y, and z value
@@ -55,5 +62,5 @@ public:
     CheckerPattern(std::initializer_list<Colour> colours);
 
     // Pattern override
-    Colour ChildApplyPattern(Point p);
+    Colour ChildApplyPattern(const Point &p) const;
 };
\ No newline at end of file
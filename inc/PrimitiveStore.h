@@ -0,0 +1,94 @@
+#pragma once
+#include "Shape.h"
+#include "Triangle.h"
+#include "Intersection.h"
+#include "Matrix.h"
+#include "Ray.h"
+#include <vector>
+
+// Type tag of a primitive in a PrimitiveStore. PRIMITIVE_SHAPE is any other shape(eg. a group or a
+// user defined subclass), which is intersected through its virtual functions
+enum PrimitiveType{
+    PRIMITIVE_SPHERE,
+    PRIMITIVE_PLANE,
+    PRIMITIVE_CUBE,
+    PRIMITIVE_CYLINDER,
+    PRIMITIVE_CONE,
+    PRIMITIVE_TRIANGLE,
+    PRIMITIVE_SHAPE
+};
+
+// Internal representation of the committed primitives of a scene. The Shape hierarchy stays the authoring
+// API, the store copies what the intersection kernels need(the world inverse and the geometry parameters)
+// into contiguous arrays per type when the BVH is built. A primitive is found through its tag and
+// its index in the arrays of that type, so intersecting it is a switch and a direct call to the type's
+// kernel instead of a virtual call on a shape somewhere on the heap.
+// The data is split by how often it is read. The hot arrays hold only what an intersection test reads, one
+// array per field so a traversal streams through inverses and geometry without pulling in anything else.
+// The cold table, indexed by primitive ID(the primitive's position in the store), holds the shape, which is
+// only read once a ray actually hits the primitive or a shadow ray needs its material
+class PrimitiveStore{
+private:
+    // Reference from a primitive ID to its index in the hot arrays of its type
+    struct PrimitiveRef{
+        PrimitiveType type;
+        int index;
+    };
+
+    // Vertices of a triangle
+    struct TriangleVertices{
+        Point p1;
+        Point p2;
+        Point p3;
+    };
+
+    // Height bounds and caps of a cylinder or cone
+    struct CappedBounds{
+        float minH;
+        float maxH;
+        bool closed;
+    };
+
+    // Hot data. Spheres, planes and cubes only need their world inverse
+    std::vector<PrimitiveRef> refs;
+    std::vector<Matrix4> sphereInverses;
+    std::vector<Matrix4> planeInverses;
+    std::vector<Matrix4> cubeInverses;
+    std::vector<Matrix4> cylinderInverses;
+    std::vector<CappedBounds> cylinderBounds;
+    std::vector<Matrix4> coneInverses;
+    std::vector<CappedBounds> coneBounds;
+    // Triangles are stored with their vertices in world space so no ray has to be transformed
+    std::vector<TriangleVertices> triangleVertices;
+    // Number of PRIMITIVE_SHAPE primitives, which are intersected through shapes
+    int otherCount = 0;
+
+    // Cold data by primitive ID, the shape is recorded in intersections. Materials are read through the shape
+    // so changes to a shape's material are seen without rebuilding the store
+    std::vector<Shape*> shapes;
+public:
+    // Returns the type a shape is stored as, only the exact built in types are stored by value so
+    // subclasses that override the intersection code keep working
+    static PrimitiveType typeOf(Shape* s);
+
+    // Adds a committed shape to the end of the store, it is intersected with its world matrices.
+    // Its ID is the size of the store before it was added
+    void add(Shape* s);
+    void clear();
+    int size() const;
+    PrimitiveType getType(int id) const;
+    // Number of primitives stored with the type
+    int count(PrimitiveType type) const;
+    // Cold data of a primitive
+    Shape* getShape(int id) const;
+    MaterialID getMaterialID(int id) const;
+    // Read through the shape, so a new material or edits to the registered one are seen
+    const Material& getMaterial(int id) const;
+
+    // Same as Shape's findWorldIntersections, closestWorldIntersection and worldOccludes for a primitive.
+    // intersect only appends the intersections of primitives stored by value that are in [tMin, tMax)
+    void intersect(int id, const Ray &r, std::vector<Intersection> &intersects, float tMin = -INFINITY, float tMax = INFINITY) const;
+    bool closestIntersection(int id, const Ray &r, float tMin, float &tMax, Intersection &hit) const;
+    // Primitives stored by value are skipped using their shape's current material before any intersection math
+    bool occludes(int id, const Ray &r, float tMin, float tMax) const;
+};
@@ -14,15 +14,15 @@ class Ray{
     public:
         // Ray constructors
         Ray();
-        Ray(Point o, Vector d);
+        Ray(const Point &o, const Vector &d);
 
         // Getters
-        Point getOrigin();
-        Vector getDirection();
+        const Point& getOrigin() const;
+        const Vector& getDirection() const;
 
         // Computes the position of the ray at time t
-        Tuple computePosition(float t);
+        Tuple computePosition(float t) const;
         
         // Returns a ray that is transformed by the matrix m
-        Ray transform(Matrix m);
+        Ray transform(const Matrix4 &m) const;
 };
@@ -0,0 +1,118 @@
+#pragma once
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "Intersection.h"
+
+// Optional instrumentation that counts the work done while rendering and times each stage.
+// Compile with -DRENDER_STATS to enable it, e.g. make stats builds main with it, or pass --copt=-DRENDER_STATS
+// to bazel for the tests and benchmarks
+// Without the flag the RENDER_STAT macros expand to nothing so the renderer pays no cost,
+// the report API still exists and returns an all zero report
+
+#ifdef RENDER_STATS
+const bool RENDER_STATS_ENABLED = true;
+#else
+const bool RENDER_STATS_ENABLED = false;
+#endif
+
+// Everything that is counted
+enum RenderCounter{
+    PRIMARY_RAYS,
+    SHADOW_RAYS,
+    REFLECTION_RAYS,
+    REFRACTION_RAYS,
+    SPHERE_TESTS,
+    SPHERE_HITS,
+    PLANE_TESTS,
+    PLANE_HITS,
+    CUBE_TESTS,
+    CUBE_HITS,
+    CYLINDER_TESTS,
+    CYLINDER_HITS,
+    CONE_TESTS,
+    CONE_HITS,
+    TRIANGLE_TESTS,
+    TRIANGLE_HITS,
+    GROUP_TESTS,
+    GROUP_HITS,
+    MATRIX_INVERSIONS,
+    PREPARE_LIGHT_DATA_CALLS,
+    RENDER_COUNTER_COUNT
+};
+
+// Stages of a render that are timed
+enum RenderStage{
+    STAGE_BVH_BUILD,
+    STAGE_TRACE,
+    STAGE_OUTPUT,
+    RENDER_STAGE_COUNT
+};
+
+// Snapshot of the counters and stage times summed over every thread
+class RenderStats{
+public:
+    uint64_t counters[RENDER_COUNTER_COUNT];
+    // Wall time of each stage in seconds
+    double stageSeconds[RENDER_STAGE_COUNT];
+
+    // RenderStats constructor, all counters and times start at 0
+    RenderStats();
+
+    uint64_t getCounter(RenderCounter c);
+    double getStageSeconds(RenderStage s);
+
+    // Human readable table of every counter and stage time
+    std::string report();
+};
+
+// Adds n to counter c for the calling thread. Each thread writes its own counters so no locking
+// is done on the render path
+void addRenderStat(RenderCounter c, uint64_t n = 1);
+// Adds seconds to the wall time of stage s
+void addStageTime(RenderStage s, double seconds);
+// Sums the counters of every thread, including threads that have already exited
+RenderStats collectRenderStats();
+// Sets every counter and stage time back to 0
+void resetRenderStats();
+
+// Name used for a counter or stage in the report
+std::string renderCounterName(RenderCounter c);
+std::string renderStageName(RenderStage s);
+
+// Adds the time between its construction and destruction to a stage
+class StageTimer{
+private:
+    RenderStage stage;
+    std::chrono::steady_clock::time_point start;
+public:
+    StageTimer(RenderStage s);
+    ~StageTimer();
+};
+
+// Counts one intersection test of a shape kernel when constructed and a hit when it is destroyed
+// if the kernel appended any intersections to the vector
+class IntersectionStat{
+private:
+    RenderCounter hits;
+    std::vector<Intersection> &intersects;
+    size_t start;
+public:
+    IntersectionStat(RenderCounter tests, RenderCounter hits, std::vector<Intersection> &intersects);
+    ~IntersectionStat();
+};
+
+#define RENDER_STATS_CONCAT_INNER(a, b) a##b
+#define RENDER_STATS_CONCAT(a, b) RENDER_STATS_CONCAT_INNER(a, b)
+
+#ifdef RENDER_STATS
+#define RENDER_STAT(c) addRenderStat(c)
+#define RENDER_STAGE_TIMER(s) StageTimer RENDER_STATS_CONCAT(renderStageTimer, __LINE__)(s)
+#define RENDER_INTERSECTION_STAT(tests, hits, intersects) \
+    IntersectionStat RENDER_STATS_CONCAT(intersectionStat, __LINE__)(tests, hits, intersects)
+#else
+#define RENDER_STAT(c) ((void)0)
+#define RENDER_STAGE_TIMER(s) ((void)0)
+#define RENDER_INTERSECTION_STAT(tests, hits, intersects) ((void)0)
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+#include "World.h"
+#include "Camera.h"
+#include "Shape.h"
+#include "Group.h"
+#include "Pattern.h"
+#include "Matrix.h"
+#include "common.h"
+#include <memory>
+#include <set>
+#include <vector>
+
+// A world together with the camera it is viewed from. Used by main and the scene benchmark so
+// both render exactly the same scenes.
+// The scene owns the shapes in its world, including the shapes inside groups, and the patterns of their
+// materials, and deletes them with the scene. A scene can be moved but not copied
+class Scene{
+private:
+    // Declared before world so the world is destroyed first, and the shapes before the patterns their
+    // materials refer to
+    std::vector<std::unique_ptr<Pattern>> patterns;
+    std::vector<std::unique_ptr<Shape>> shapes;
+
+    // Takes ownership of s and everything below it
+    void own(Shape* s, std::set<Pattern*> &owned);
+public:
+    World world;
+    Camera camera;
+
+    // Scene constructor, takes ownership of the world's shapes and their patterns
+    Scene(World w, Camera c);
+};
+
+// The scene rendered by main, a cone and two patterned spheres
+Scene mainScene(int hsize = 100, int vsize = 50);
+// defaultWorld() viewed from the front
+Scene defaultScene(int hsize = 100, int vsize = 100);
+// Reflective and refractive scene, a glass sphere with an air bubble over a checkered mirror floor
+Scene glassScene(int hsize = 100, int vsize = 100);
+// Grid of objects spheres, cubes and cylinders on a floor, used to measure how rendering scales with
+// the number of objects
+Scene stressScene(int objects, int hsize = 100, int vsize = 100);
@@ -4,7 +4,11 @@
 #include "Tuple.h"
 #include "Intersection.h"
 #include "Ray.h"
+#include "BoundingBox.h"
+#include "MaterialRegistry.h"
 #include <stdexcept>
+#include <cmath>
+#include "RenderStats.h"
 class Group;
 // Forward declaration of group because group is a child of shape and contains shapes
 // A shape can have a group it belongs to
@@ -12,30 +16,112 @@ class Group;
 // Parent class for all objects that can be rendered
 class Shape{
 protected:
-    // Stores material of shape and the matrix transformation that is applied to the shape
-    Matrix transform = Matrix(4);
-    Material material = Material();
+    // Stores the matrix transformation that is applied to the shape
+    Matrix4 transform = Matrix4();
+    // Inverse and inverse transpose of transform, recomputed by setTransform so the
+    // intersection and normal code never has to invert the transform per ray
+    Matrix4 inverseTransform = Matrix4();
+    Matrix4 inverseTranspose = Matrix4();
+    // ID of the shape's material in materialRegistry(), the shape holds a reference to it. ownsMaterial is true
+    // if the material was added by setMaterial for this shape only, it is then edited in place by setMaterial
+    MaterialID materialID = DEFAULT_MATERIAL;
+    bool ownsMaterial = false;
+    // Uses a material other shapes may use too, in place of the shape's current one
+    void useMaterial(MaterialID id);
     Group* parent = nullptr;
+    // Transform from object space to world space including the transforms of every parent group, with
+    // its inverse and inverse transpose. Set by commitTransforms, a shape without a parent keeps them
+    // equal to its own transform so it never needs to be committed
+    Matrix4 worldTransform = Matrix4();
+    Matrix4 worldInverse = Matrix4();
+    Matrix4 worldInverseTranspose = Matrix4();
+    // False while the world matrices are out of date, ie. the shape or one of the groups above it was
+    // added to a group or transformed inside one since it was last committed
+    bool worldCommitted = true;
+
+    // Finds the intersections of a ray that is already in object space, shared by the parent space and world
+    // space queries. The defaults search the intersections childIntersections finds in the range, shapes
+    // with an internal acceleration structure override them to stop early
+    virtual bool closestObjectIntersection(const Ray &objectRay, float tMin, float &tMax, Intersection &hit);
+    virtual bool objectOccludes(const Ray &objectRay, float tMin, float tMax);
 public:
+    // Shape constructors and destructor. A copy gets its own copy of a material owned by the shape
+    // and shares a registered material
+    Shape();
+    Shape(const Shape &s);
+    Shape& operator=(const Shape &s);
+    virtual ~Shape();
+
     // Getter and setter for transform and material
-    Matrix getTransform();
-    void setTransform(Matrix m);
-    Material getMaterial();
-    void setMaterial(Material m);
-    Group* getParent();
+    const Matrix4& getTransform() const;
+    void setTransform(const Matrix4 &m);
+    const Matrix4& getInverseTransform() const;
+    const Matrix4& getInverseTranspose() const;
+    // Returns the shape's material from the registry
+    const Material& getMaterial() const;
+    // Gives the shape its own copy of m, shapes that should share a material use setMaterialID instead
+    void setMaterial(const Material &m);
+    // Uses a material registered in materialRegistry(), edits to it apply to every shape using the ID
+    MaterialID getMaterialID() const;
+    void setMaterialID(MaterialID id);
+    Group* getParent() const;
     void setParent(Group* p);
+    const Matrix4& getWorldTransform() const;
+    const Matrix4& getWorldInverse() const;
+    bool isWorldCommitted() const;
+    // Marks the world matrices out of date until the next commit, groups also mark every shape below them
+    virtual void invalidateWorldTransforms();
+
+    // Scene commit step that flattens group hierarchies. Composes the world matrices of the shape from the
+    // world transform of its parent and that transform's inverse, then appends the shape to primitives.
+    // Groups commit their children instead of appending themselves, so primitives only holds leaf shapes
+    // which can be intersected in world space without walking the hierarchy. Has to be called again
+    // after any transform in the hierarchy changes
+    virtual void commitTransforms(const Matrix4 &parentTransform, const Matrix4 &parentInverse, std::vector<Shape*> &primitives);
 
-    // Returns a vector of intersection objects where the ray r intersects the surface of the shape
-    // findIntersections does some preprocessing that would be done for any shape
-    std::vector<Intersection> findIntersections(Ray r);
+    // Appends intersection objects where the ray r intersects the surface of the shape to intersects
+    // findIntersections does some preprocessing that would be done for any shape. Appending to a buffer
+    // owned by the caller lets the buffer be reused between rays instead of allocating a vector per shape
+    void findIntersections(const Ray &r, std::vector<Intersection> &intersects);
+    // Returns the intersections in a new vector
+    std::vector<Intersection> findIntersections(const Ray &r);
     // childIntersections executes custom code depending on what child class is being executed
-    virtual std::vector<Intersection> childIntersections(Ray r);
+    virtual void childIntersections(const Ray &r, std::vector<Intersection> &intersects);
+    std::vector<Intersection> childIntersections(const Ray &r);
+    // Appends the intersections in [tMin, tMax), used by the closest hit and shadow queries. The built in
+    // shapes pass the range to their kernels so they reject hits outside it early, the default appends
+    // every intersection and leaves the range check to the caller
+    virtual void childIntersections(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax);
+    // Finds the intersection with the lowest time in [tMin, tMax). If there is one, hit is set to it,
+    // tMax is lowered to its time and true is returned. Used to find the nearest hit without sorting
+    bool closestIntersection(const Ray &r, float tMin, float &tMax, Intersection &hit);
+    // Checks if the ray hits a shape that casts shadows at a time in (tMin, tMax). Used for shadow rays,
+    // which only need to know whether anything blocks the light
+    bool occludes(const Ray &r, float tMin, float tMax);
+    // findIntersections, closestIntersection and occludes for a ray in world space. They use the world
+    // matrices instead of the shape's own transform so committed primitives are tested without their groups
+    void findWorldIntersections(const Ray &r, std::vector<Intersection> &intersects);
+    bool closestWorldIntersection(const Ray &r, float tMin, float &tMax, Intersection &hit);
+    bool worldOccludes(const Ray &r, float tMin, float tMax);
 
-    // Computes the normal vector of a point on the surface of the shape
-    // findIntersections does some preprocessing that would be done for any shape
-    Vector computeNormal(Point p);
+    // Computes the normal vector of a point in world space on the surface of the shape
+    // Uses the committed world matrices, or walks up the parent groups if they are out of date
+    Vector computeNormal(const Point &p);
+    // Same as computeNormal for the point where the intersection hit, so shapes made of parts can use the
+    // part that was hit
+    Vector computeNormal(const Point &p, const Intersection &hit);
     // childIntersections executes custom code depending on what child class is being executed
-    virtual Vector childNormal(Point p);
+    virtual Vector childNormal(const Point &p);
+    // Normal at a point hit by an intersection, the default ignores the intersection
+    virtual Vector childHitNormal(const Point &p, const Intersection &hit);
+
+    // Returns the bounding box of the shape in the space of its parent(world space if it has no parent)
+    // getBounds applies the shape's transform to the box computed by childBounds
+    BoundingBox getBounds();
+    // Bounding box of the shape in world space using the committed world transform
+    BoundingBox getWorldBounds();
+    // childBounds returns the bounding box of the untransformed child shape
+    virtual BoundingBox childBounds();
 
     // Equality check function
     virtual bool isEqual(Shape* s);
@@ -43,9 +129,9 @@ public:
     // Recursive functions for groups
     // Converts a point in the world to a point relative to the shape
     // Utilizes the shape's transform as well as any parent group transforms
-    Point worldToObject(Point p);
+    Point worldToObject(const Point &p);
     // Converts a normal vector relative to the shape to a vector in the world coordinates
-    Vector normalToWorld(Vector normal);
+    Vector normalToWorld(const Vector &normal);
 };
 
 // Class to represent spheres in the canvas, stores origin and radius, origin is center of sphere
@@ -60,17 +146,25 @@ class Sphere: public Shape{
         Sphere();
 
         // Getters for sphere variables
-        float getRadius();
-        Point getOrigin();
+        float getRadius() const;
+        const Point& getOrigin() const;
 
         // Checks if sphere is equal to s
         bool isEqual(Shape* s);
 
         // Shape class override functions
         // Computes all intersections of the ray r with the sphere
-        std::vector<Intersection> childIntersections(Ray r);
+        using Shape::childIntersections;
+        void childIntersections(const Ray &r, std::vector<Intersection> &intersects);
+        void childIntersections(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax);
+        // Intersection kernel of the default sphere, a unit sphere centred at the origin. s is the shape the
+        // intersections belong to. Like the other kernels it only appends intersections in [tMin, tMax) and
+        // stops once no others can be
+        static void intersect(const Ray &r, Shape* s, std::vector<Intersection> &intersects, float tMin = -INFINITY, float tMax = INFINITY);
         // Computes normal vector at point p on the sphere
-        Vector childNormal(Point p);
+        Vector childNormal(const Point &p);
+        // Bounding box of the default sphere
+        BoundingBox childBounds();
 };
 
 Sphere* glassSphere();
@@ -80,22 +174,33 @@ class Plane : public Shape{
 public:
     // Shape class override functions
     // Computes the point of intersection of a ray on the plane 
-    std::vector<Intersection> childIntersections(Ray r);
+    using Shape::childIntersections;
+    void childIntersections(const Ray &r, std::vector<Intersection> &intersects);
+    void childIntersections(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax);
+    // Intersection kernel of the default plane, s is the shape the intersections belong to
+    static void intersect(const Ray &r, Shape* s, std::vector<Intersection> &intersects, float tMin = -INFINITY, float tMax = INFINITY);
     // The normal vector at any point on the plane is the same
     // The default plane is an xz plane, so the normal vector will be Vector(0, 1, 0)
-    Vector childNormal(Point p);
+    Vector childNormal(const Point &p);
+    // The plane extends infinitely in x and z and has no thickness in y
+    BoundingBox childBounds();
 };
 
 // Class to represent cubes, default cube has a side length of 2 and origin at Point(0, 0, 0)
 class Cube : public Shape{
 public:
     // Shape class override functions
-    std::vector<Intersection> childIntersections(Ray r);
-    Vector childNormal(Point p);
+    using Shape::childIntersections;
+    void childIntersections(const Ray &r, std::vector<Intersection> &intersects);
+    void childIntersections(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax);
+    // Intersection kernel of the default cube, s is the shape the intersections belong to
+    static void intersect(const Ray &r, Shape* s, std::vector<Intersection> &intersects, float tMin = -INFINITY, float tMax = INFINITY);
+    Vector childNormal(const Point &p);
+    BoundingBox childBounds();
 };
 
-// Cube helper function for computing intersections
-std::vector<float> check_axis(float origin, float direction);
+// Cube helper function for computing intersections, sets tmin and tmax to the times the ray hits the two faces on one axis
+void check_axis(float origin, float direction, float &tmin, float &tmax);
 
 // Class to represent cylinders, the default cylinder extends infinitely in the +y and -y direction on the y axis
 class Cylinder : public Shape{
@@ -118,12 +223,20 @@ public:
     void setClosed(bool c);
 
     // Shape class override functions
-    std::vector<Intersection> childIntersections(Ray r);
-    Vector childNormal(Point p);
+    using Shape::childIntersections;
+    void childIntersections(const Ray &r, std::vector<Intersection> &intersects);
+    void childIntersections(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax);
+    Vector childNormal(const Point &p);
+    BoundingBox childBounds();
+
+    // Intersection kernel of a cylinder with the given height bounds and caps, the virtual childIntersections
+    // passes the cylinder's own values. s is the shape the intersections belong to
+    static void intersect(const Ray &r, float minH, float maxH, bool closed, Shape* s, std::vector<Intersection> &intersects, float tMin = -INFINITY, float tMax = INFINITY);
 
     // Intersection helper functions for the top and bottom caps
-    static bool insideCapRadius(Ray r, float t);
-    void intersectCaps(Ray r, std::vector<Intersection> &intersects);
+    static bool insideCapRadius(const Ray &r, float t);
+    void intersectCaps(const Ray &r, std::vector<Intersection> &intersects);
+    static void intersectCaps(const Ray &r, float minH, float maxH, bool closed, Shape* s, std::vector<Intersection> &intersects, float tMin = -INFINITY, float tMax = INFINITY);
 };
 
 // Class to represent cones, the default cone extends infinitely in the +y and -y direction on the y axis
@@ -147,10 +260,18 @@ public:
     void setClosed(bool c);
 
     // Shape class override functions
-    std::vector<Intersection> childIntersections(Ray r);
-    Vector childNormal(Point p);
+    using Shape::childIntersections;
+    void childIntersections(const Ray &r, std::vector<Intersection> &intersects);
+    void childIntersections(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax);
+    Vector childNormal(const Point &p);
+    BoundingBox childBounds();
+
+    // Intersection kernel of a cone with the given height bounds and caps, the virtual childIntersections
+    // passes the cone's own values. s is the shape the intersections belong to
+    static void intersect(const Ray &r, float minH, float maxH, bool closed, Shape* s, std::vector<Intersection> &intersects, float tMin = -INFINITY, float tMax = INFINITY);
 
     // Intersection helper functions for the top and bottom caps
-    static bool insideCapRadius(Ray r, float t, float radius);
-    void intersectCaps(Ray r, std::vector<Intersection> &intersects);
+    static bool insideCapRadius(const Ray &r, float t, float radius);
+    void intersectCaps(const Ray &r, std::vector<Intersection> &intersects);
+    static void intersectCaps(const Ray &r, float minH, float maxH, bool closed, Shape* s, std::vector<Intersection> &intersects, float tMin = -INFINITY, float tMax = INFINITY);
 };
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+// Work stealing thread pool used to split work such as rendering over multiple cores.
+// The worker threads are started by the constructor and live as long as the pool, between calls they wait
+// on a condition variable, so thread local buffers and counters of the workers survive from one call to
+// the next. Tasks are dealt out round robin into one queue per worker. A worker takes tasks from
+// the front of its own queue and once that is empty it steals from the back of the
+// other workers' queues, so a worker that got cheap tasks helps out the rest
+class ThreadPool{
+private:
+    // Queue of task indices owned by one worker, the mutex guards the queue
+    struct WorkQueue{
+        std::deque<int> tasks;
+        std::mutex lock;
+    };
+
+    // One parallelFor call, shared by the calling thread and the workers
+    struct Job{
+        const std::function<void(int)>* task;
+        std::vector<WorkQueue> queues;
+        std::atomic<bool> failed;
+        std::exception_ptr error;
+        std::mutex errorLock;
+    };
+
+    int threadCount;
+    // Workers 1 to threadCount - 1, the thread calling parallelFor acts as worker 0
+    std::vector<std::thread> workers;
+
+    // Guards job, generation, busy and stopping. Workers wait on wake for the generation to change and
+    // parallelFor waits on done for every worker to finish the job
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    Job* job = nullptr;
+    long generation = 0;
+    int busy = 0;
+    bool stopping = false;
+    // Held for a whole parallelFor call, so calls from several threads run one after the other
+    std::mutex callLock;
+
+    // Pops the next task for worker w, from its own queue first and then from the other queues
+    // Returns -1 when every queue is empty
+    int nextTask(std::vector<WorkQueue> &queues, int w);
+    // Runs tasks of the job as worker w until none are left or one has thrown
+    void runTasks(Job &j, int w);
+    // Body of a worker thread, runs its share of each job until the pool is destroyed
+    void workerLoop(int w);
+public:
+    // ThreadPool constructor, a thread count below 1 uses the number of hardware threads
+    ThreadPool(int threads = 0);
+    // Stops and joins the workers
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool& operator=(const ThreadPool &) = delete;
+
+    int getThreadCount();
+
+    // Runs task(i) for every i in [0, taskCount) across the pool and returns once all tasks are done
+    // If a task throws, the remaining tasks are skipped and the first exception is rethrown.
+    // A call made from inside one of the pool's own tasks runs its tasks on the calling thread
+    void parallelFor(int taskCount, std::function<void(int)> task);
+};
+
+// Pool with the thread count shared by the whole program, created on first use and never destroyed so
+// its workers are only started once. Used by rendering, image writing and the OBJ parser
+ThreadPool& sharedThreadPool(int threads = 0);
@@ -0,0 +1,140 @@
+#pragma once
+#include "Shape.h"
+#include "BoundingBox.h"
+#include "Intersection.h"
+#include "Ray.h"
+#include "Tuple.h"
+#include <cstdint>
+#include <vector>
+
+// Ray prepared for the watertight ray/triangle test from "Watertight Ray/Triangle Intersection" by Woop,
+// Benthin and Wald. The coordinate system is permuted and sheared so the ray starts at the origin and
+// points along +z, which turns the test into 2D edge functions. The set up is done once per ray and
+// shared by every triangle it is tested against
+class WatertightRay{
+public:
+    Point origin;
+    // kz is the axis the direction is largest on, kx and ky are the other two axes
+    int kx;
+    int ky;
+    int kz;
+    // Shear constants that map the direction onto the +z axis
+    float sx;
+    float sy;
+    float sz;
+
+    WatertightRay(const Ray &r);
+};
+
+// Sets t to the time the ray hits the triangle abc and returns true if it does, both sides of the triangle
+// are hit. The edge functions are recomputed in double precision when one is exactly 0, so a ray through a
+// shared edge or vertex hits at least one of the triangles and rays can't slip through gaps in a mesh.
+// Tests one triangle, TriangleMesh tests the triangles of a BVH leaf together with a batched version
+bool intersectTriangle(const WatertightRay &r, const Point &a, const Point &b, const Point &c, float &t);
+
+// A single triangle with vertices p1, p2 and p3
+class Triangle : public Shape{
+private:
+    Point p1;
+    Point p2;
+    Point p3;
+    // Edge vectors p2 - p1 and p3 - p1, and the unit normal computed from them
+    Vector e1;
+    Vector e2;
+    Vector normal;
+public:
+    // Triangle constructor
+    Triangle(const Point &p1, const Point &p2, const Point &p3);
+
+    // Getters
+    const Point& getP1() const;
+    const Point& getP2() const;
+    const Point& getP3() const;
+    const Vector& getE1() const;
+    const Vector& getE2() const;
+    const Vector& getNormal() const;
+
+    // Shape class override functions
+    using Shape::childIntersections;
+    void childIntersections(const Ray &r, std::vector<Intersection> &intersects);
+    void childIntersections(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax);
+    // Intersection kernel of the triangle p1 p2 p3, s is the shape the intersections belong to
+    static void intersect(const Ray &r, const Point &p1, const Point &p2, const Point &p3, Shape* s, std::vector<Intersection> &intersects, float tMin = -INFINITY, float tMax = INFINITY);
+    // The normal is the same everywhere on the triangle
+    Vector childNormal(const Point &p);
+    BoundingBox childBounds();
+};
+
+// Triangle mesh stored as a shared vertex buffer and a buffer of 32 bit indices, three per triangle. The
+// edge vectors and normal of each triangle are computed once when the mesh is made, and the triangles are
+// put in the mesh's own bounding volume hierarchy so a ray only tests the triangles whose boxes it passes
+// through. The mesh is one Shape, it is transformed, given a material and added to a World or Group like
+// any other shape. Its intersections record the index of the triangle that was hit
+class TriangleMesh : public Shape{
+private:
+    // Node of the mesh's BVH. Leaf nodes store a range [start, start + count) of order, interior nodes
+    // store the indices of their two children in nodes
+    struct Node{
+        BoundingBox bounds;
+        int left;
+        int right;
+        int start;
+        int count;
+    };
+
+    // Edge vectors of a triangle, p2 - p1 and p3 - p1
+    struct TriangleEdges{
+        Vector e1;
+        Vector e2;
+    };
+
+    std::vector<Point> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<TriangleEdges> edges;
+    std::vector<Vector> normals;
+    std::vector<Node> nodes;
+    // Triangle numbers reordered during the build so each leaf's triangles are contiguous
+    std::vector<uint32_t> order;
+    // Vertices of the triangles in the same order as order, as one array per corner and axis. A leaf's
+    // triangles are then side by side in every array and the leaf kernel reads them as SIMD lanes
+    std::vector<float> corners[3][3];
+
+    // Recursively builds the node containing triangles order[start, end), returns the index of the node
+    int buildNode(const std::vector<BoundingBox> &boxes, int start, int end, int depth);
+    // Vertices of triangle i
+    const Point& vertex(int i, int corner) const;
+    // Tests the count triangles at order[start, start + count) together, count is at most MAX_LEAF_SIZE.
+    // times[k] is set to the time the ray hits triangle order[start + k] at, NAN if it misses it
+    void intersectLeaf(const WatertightRay &r, int start, int count, float* times) const;
+protected:
+    // Walk the BVH nearest node first and skip nodes beyond the closest hit, or stop at the first hit
+    bool closestObjectIntersection(const Ray &objectRay, float tMin, float &tMax, Intersection &hit);
+    bool objectOccludes(const Ray &objectRay, float tMin, float tMax);
+public:
+    // Maximum number of triangles in a leaf
+    static const int MAX_LEAF_SIZE = 4;
+    // Maximum depth of the tree, the median split keeps the depth at about log2 of the triangle count
+    static const int MAX_DEPTH = 64;
+
+    // Builds the mesh, throws if the number of indices isn't a multiple of 3 or an index is out of range
+    TriangleMesh(std::vector<Point> vertices, std::vector<uint32_t> indices);
+
+    // Getters
+    const std::vector<Point>& getVertices() const;
+    const std::vector<uint32_t>& getIndices() const;
+    int getTriangleCount() const;
+    int getNodeCount() const;
+    const Vector& getE1(int triangle) const;
+    const Vector& getE2(int triangle) const;
+    const Vector& getNormal(int triangle) const;
+
+    // Shape class override functions
+    // Appends the intersections with every triangle the ray hits, in no particular order
+    using Shape::childIntersections;
+    void childIntersections(const Ray &r, std::vector<Intersection> &intersects);
+    // Normal of the triangle that contains p, searches the triangles so childHitNormal is used when the hit is known
+    Vector childNormal(const Point &p);
+    // Normal of the triangle recorded in the intersection
+    Vector childHitNormal(const Point &p, const Intersection &hit);
+    BoundingBox childBounds();
+};
@@ -2,8 +2,16 @@
 #include "common.h"
 #include <cmath>
 
-// Parent class for points and vectors
-class Tuple{
+// Tuple operations use SSE when the compiler targets it. Define RENDERER_NO_SIMD to
+// force the scalar implementation
+#if (defined(__SSE__) || defined(_M_X64)) && !defined(RENDERER_NO_SIMD)
+#define TUPLE_SIMD 1
+#include <xmmintrin.h>
+#endif
+
+// Parent class for points and vectors. Aligned to 16 bytes so x, y, z and point can be
+// loaded into one SIMD register
+class alignas(16) Tuple{
     public:
         float x, y, z;
         // A variable to store the state of the tuple(1.0 for point, 0.0 for vector)
@@ -15,13 +23,19 @@ class Tuple{
         // Tuple constructors
         Tuple();
         Tuple(float x, float y, float z, float point);
-        bool isEqual(Tuple a);
+        bool isEqual(const Tuple &a) const;
         // Tuple Operations
-        Tuple operator+(Tuple b);
-        Tuple operator-(Tuple b);
-        Tuple operator*(float scale);
-        Tuple operator/(float scale);
-        Tuple negateTuple();
+        Tuple operator+(const Tuple &b) const;
+        Tuple operator-(const Tuple &b) const;
+        Tuple operator*(float scale) const;
+        Tuple operator/(float scale) const;
+        Tuple negateTuple() const;
+
+#ifdef TUPLE_SIMD
+        // Converts between the tuple and a SIMD register holding (x, y, z, point)
+        Tuple(__m128 v);
+        __m128 toSIMD() const;
+#endif
 };
 
 // Class for a point, inherits from Tuple
@@ -30,7 +44,7 @@ class Point: public Tuple{
         // Point constructors
         Point();
         Point(float x, float y, float z);
-        Point(Tuple t);
+        Point(const Tuple &t);
 };
 
 // Class for a vector, inherits from Tuple
@@ -39,13 +53,13 @@ class Vector: public Tuple{
         // Vector constructors
         Vector();
         Vector(float x, float y, float z);
-        Vector(Tuple t);
+        Vector(const Tuple &t);
 
         // Vector Operations
-        float magnitude();
-        Vector normalize();
+        float magnitude() const;
+        Vector normalize() const;
 };
 
 // More Vector Operations
-float dotProduct(Vector a, Vector b);
-Vector crossProduct(Vector a, Vector b);
+float dotProduct(const Vector &a, const Vector &b);
+Vector crossProduct(const Vector &a, const Vector &b);
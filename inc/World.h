@@ -9,37 +9,58 @@
 #include "LightData.h"
 #include "Config.h"
 #include "Shape.h"
+#include "BVH.h"
+#include "RenderStats.h"
 
 // Class to store all objects in the environment
 class World{
 private:
     // Stores all objects in the world and the light source
     std::vector<Shape*> objects;
+    // Leaf shapes of objects with every group flattened away, filled in by buildBVH
+    std::vector<Shape*> primitives;
     LightSource light;
+    // Acceleration structure over objects, only used by RayIntersection after buildBVH is called
+    // and cleared whenever the list of objects changes
+    BVH bvh;
+    bool bvhBuilt = false;
 public:
     // World constructor
     World();
 
     // Getters and setters for variables
-    std::vector<Shape*> getObjects();
-    LightSource getLight();
+    const std::vector<Shape*>& getObjects() const;
+    const LightSource& getLight() const;
 
     void appendObject(Shape* s);
-    void setLight(LightSource l);
+    void setLight(const LightSource &l);
+    // Takes the vector by value so callers can move it in
     void setObjects(std::vector<Shape*> obj);
 
+    // Commits the objects' transforms, flattening groups into primitives, and builds the BVH over the
+    // primitives. Must be called again if objects are transformed afterwards
+    void buildBVH();
+    const std::vector<Shape*>& getPrimitives() const;
+    bool hasBVH() const;
+
     // Returns a vector of intersection objects where the ray r intersects the surface of an object in the world
-    std::vector<Intersection> RayIntersection(Ray r);
+    std::vector<Intersection> RayIntersection(const Ray &r) const;
+    // Clears intersects and fills it with the sorted intersections, reusing the vector's storage
+    void RayIntersection(const Ray &r, std::vector<Intersection> &intersects) const;
+    // Finds the intersection with the lowest time in [tMin, tMax) without building and sorting the list of
+    // all intersections. Sets hit and returns true if there is one
+    bool closestHit(const Ray &r, Intersection &hit, float tMin = 0, float tMax = INFINITY) const;
     // Returns the computed colour of a hit using the world light source and the LightData data structure
-    Colour shadeHit(LightData data, int remaining = RECURSIVE_REFLECT_LIMIT);
+    Colour shadeHit(const LightData &data, int remaining = RECURSIVE_REFLECT_LIMIT) const;
     // Computes the colour at the first point hit by the ray r
-    Colour colourAtHit(Ray r, int remaining = RECURSIVE_REFLECT_LIMIT);
+    Colour colourAtHit(const Ray &r, int remaining = RECURSIVE_REFLECT_LIMIT) const;
     // Checks if a point p in the world is covered by a shadow(object between point and light source)
-    bool hasShadow(Point p);
+    // Only objects whose material casts shadows can block the light
+    bool hasShadow(const Point &p) const;
     // Computes the reflected colour using LightData and the material's reflective attribute
-    Colour reflectedColour(LightData data, int remaining = RECURSIVE_REFLECT_LIMIT);
+    Colour reflectedColour(const LightData &data, int remaining = RECURSIVE_REFLECT_LIMIT) const;
     // Computes the reflected colour using LightData and the material's refractive index and transparency attribute
-    Colour refractedColour(LightData data, int remaining = RECURSIVE_REFLECT_LIMIT);
+    Colour refractedColour(const LightData &data, int remaining = RECURSIVE_REFLECT_LIMIT) const;
 };
 
 // Returns a default world with a light source and two spheres
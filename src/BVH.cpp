@@ -0,0 +1,271 @@
+#include "BVH.h"
+
+// BVH constructors
+BVH::BVH(){}
+
+// Builds the tree over the objects, objects with infinite bounds are stored separately
+BVH::BVH(const std::vector<Shape*> &objects){
+    for(int i = 0; i < objects.size(); i++){
+        BoundingBox b = objects.at(i)->getWorldBounds();
+        if(b.isEmpty()){
+            // Shape can never be hit(eg. an empty group)
+            continue;
+        }else if(!b.isFinite()){
+            unbounded.push_back(objects.at(i));
+        }else{
+            // Pad the box so rays grazing the shape aren't culled by floating point error
+            b.pad(EPSILON);
+            shapes.push_back(objects.at(i));
+            shapeBounds.push_back(b);
+        }
+    }
+
+    if(!shapes.empty()){
+        buildNode(0, shapes.size(), 0);
+    }
+
+    // The store is filled after the build has reordered the shapes, so a leaf's range of shapes is
+    // also its range of primitives. The unbounded shapes follow the bounded ones
+    for(int i = 0; i < shapes.size(); i++){
+        store.add(shapes.at(i));
+    }
+    for(int i = 0; i < unbounded.size(); i++){
+        store.add(unbounded.at(i));
+    }
+}
+
+// Getters
+int BVH::getNodeCount() const{
+    return nodes.size();
+}
+
+const std::vector<Shape*>& BVH::getUnbounded() const{
+    return unbounded;
+}
+
+const PrimitiveStore& BVH::getPrimitiveStore() const{
+    return store;
+}
+
+BoundingBox BVH::getBounds() const{
+    if(nodes.empty()){
+        return BoundingBox();
+    }
+    return nodes.at(0).bounds;
+}
+
+// Builds the node for shapes [start, end). Tries splitting the shapes on each axis at the boundaries
+// between SAH_BUCKETS equal sized buckets of the centroids, and keeps the split with the lowest
+// SAH cost. If no split is cheaper than testing every shape and the shapes fit in a leaf, a leaf is made
+int BVH::buildNode(int start, int end, int depth){
+    int index = nodes.size();
+    nodes.push_back(Node());
+
+    BoundingBox bounds;
+    BoundingBox centroidBounds;
+    for(int i = start; i < end; i++){
+        bounds.merge(shapeBounds.at(i));
+        centroidBounds.addPoint(shapeBounds.at(i).centroid());
+    }
+    nodes.at(index).bounds = bounds;
+
+    int count = end - start;
+    float bestCost = INFINITY;
+    int bestAxis = -1;
+    int bestSplit = 0;
+
+    float cmin[3] = {centroidBounds.getMin().x, centroidBounds.getMin().y, centroidBounds.getMin().z};
+    float cmax[3] = {centroidBounds.getMax().x, centroidBounds.getMax().y, centroidBounds.getMax().z};
+
+    for(int axis = 0; axis < 3 && count > 1; axis++){
+        float extent = cmax[axis] - cmin[axis];
+        if(extent <= 0){
+            continue;
+        }
+
+        // Sorts the shapes into buckets by centroid
+        BoundingBox bucketBounds[SAH_BUCKETS];
+        int bucketCounts[SAH_BUCKETS] = {0};
+        for(int i = start; i < end; i++){
+            Point c = shapeBounds.at(i).centroid();
+            float value = axis == 0 ? c.x : (axis == 1 ? c.y : c.z);
+            int b = std::min((int)(SAH_BUCKETS*(value - cmin[axis])/extent), SAH_BUCKETS - 1);
+            bucketCounts[b]++;
+            bucketBounds[b].merge(shapeBounds.at(i));
+        }
+
+        // Cost of splitting after bucket s is SA(left)*count(left) + SA(right)*count(right)
+        for(int s = 0; s < SAH_BUCKETS - 1; s++){
+            BoundingBox left, right;
+            int leftCount = 0, rightCount = 0;
+            for(int b = 0; b <= s; b++){
+                left.merge(bucketBounds[b]);
+                leftCount += bucketCounts[b];
+            }
+            for(int b = s + 1; b < SAH_BUCKETS; b++){
+                right.merge(bucketBounds[b]);
+                rightCount += bucketCounts[b];
+            }
+            if(leftCount == 0 || rightCount == 0){
+                continue;
+            }
+
+            float cost = left.surfaceArea()*leftCount + right.surfaceArea()*rightCount;
+            if(cost < bestCost){
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = s;
+            }
+        }
+    }
+
+    // Cost of a leaf is testing every shape, the split cost is relative to the parent's surface area
+    // A leaf is also made if the shapes can't be split(one shape or identical centroids) or the tree is
+    // at its maximum depth
+    float leafCost = bounds.surfaceArea()*count;
+    if(bestAxis == -1 || depth >= MAX_DEPTH || (count <= MAX_LEAF_SIZE && bestCost >= leafCost)){
+        nodes.at(index).start = start;
+        nodes.at(index).count = count;
+        nodes.at(index).left = -1;
+        nodes.at(index).right = -1;
+        return index;
+    }
+
+    // Partitions the shapes so the shapes in the buckets left of the split come first
+    int mid = start;
+    float extent = cmax[bestAxis] - cmin[bestAxis];
+    for(int i = start; i < end; i++){
+        Point c = shapeBounds.at(i).centroid();
+        float value = bestAxis == 0 ? c.x : (bestAxis == 1 ? c.y : c.z);
+        int b = std::min((int)(SAH_BUCKETS*(value - cmin[bestAxis])/extent), SAH_BUCKETS - 1);
+        if(b <= bestSplit){
+            std::swap(shapes.at(i), shapes.at(mid));
+            std::swap(shapeBounds.at(i), shapeBounds.at(mid));
+            mid++;
+        }
+    }
+
+    int left = buildNode(start, mid, depth + 1);
+    int right = buildNode(mid, end, depth + 1);
+    nodes.at(index).start = 0;
+    nodes.at(index).count = 0;
+    nodes.at(index).left = left;
+    nodes.at(index).right = right;
+    return index;
+}
+
+// Walks the tree with a stack, skipping every subtree whose box the ray misses
+void BVH::intersect(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax) const{
+    for(int i = 0; i < unbounded.size(); i++){
+        store.intersect(shapes.size() + i, r, intersects);
+    }
+
+    if(nodes.empty()){
+        return;
+    }
+
+    // A node's children are pushed together, so the stack never holds more than MAX_DEPTH + 1 nodes
+    int stack[MAX_DEPTH + 1];
+    int top = 0;
+    stack[top++] = 0;
+    while(top > 0){
+        const Node &node = nodes.at(stack[--top]);
+        if(!node.bounds.intersects(r, tMin, tMax)){
+            continue;
+        }
+
+        if(node.count > 0){
+            for(int i = node.start; i < node.start + node.count; i++){
+                store.intersect(i, r, intersects);
+            }
+        }else{
+            stack[top++] = node.right;
+            stack[top++] = node.left;
+        }
+    }
+}
+
+// Walks the tree nearest child first, lowering tMax every time a closer hit is found so any node
+// the ray enters after tMax can be skipped
+bool BVH::closestHit(const Ray &r, Intersection &hit, float tMin, float tMax) const{
+    bool found = false;
+    for(int i = 0; i < unbounded.size(); i++){
+        found = store.closestIntersection(shapes.size() + i, r, tMin, tMax, hit) || found;
+    }
+
+    if(nodes.empty()){
+        return found;
+    }
+
+    int stack[MAX_DEPTH + 1];
+    int top = 0;
+    stack[top++] = 0;
+    while(top > 0){
+        const Node &node = nodes.at(stack[--top]);
+        if(!node.bounds.intersects(r, tMin, tMax)){
+            continue;
+        }
+
+        if(node.count > 0){
+            for(int i = node.start; i < node.start + node.count; i++){
+                found = store.closestIntersection(i, r, tMin, tMax, hit) || found;
+            }
+        }else{
+            // Pushes the farther child first so the nearer child is visited first
+            float leftEnter, rightEnter;
+            bool hitLeft = nodes.at(node.left).bounds.intersects(r, tMin, tMax, leftEnter);
+            bool hitRight = nodes.at(node.right).bounds.intersects(r, tMin, tMax, rightEnter);
+            if(hitLeft && hitRight){
+                if(leftEnter <= rightEnter){
+                    stack[top++] = node.right;
+                    stack[top++] = node.left;
+                }else{
+                    stack[top++] = node.left;
+                    stack[top++] = node.right;
+                }
+            }else if(hitLeft){
+                stack[top++] = node.left;
+            }else if(hitRight){
+                stack[top++] = node.right;
+            }
+        }
+    }
+
+    return found;
+}
+
+// Any hit query for shadow rays, the traversal order doesn't matter since it returns at the first occluder
+bool BVH::occluded(const Ray &r, float tMin, float tMax) const{
+    for(int i = 0; i < unbounded.size(); i++){
+        if(store.occludes(shapes.size() + i, r, tMin, tMax)){
+            return true;
+        }
+    }
+
+    if(nodes.empty()){
+        return false;
+    }
+
+    int stack[MAX_DEPTH + 1];
+    int top = 0;
+    stack[top++] = 0;
+    while(top > 0){
+        const Node &node = nodes.at(stack[--top]);
+        if(!node.bounds.intersects(r, tMin, tMax)){
+            continue;
+        }
+
+        if(node.count > 0){
+            for(int i = node.start; i < node.start + node.count; i++){
+                if(store.occludes(i, r, tMin, tMax)){
+                    return true;
+                }
+            }
+        }else{
+            stack[top++] = node.right;
+            stack[top++] = node.left;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,141 @@
+#include "BoundingBox.h"
+
+// BoundingBox constructors
+// An empty box has its minimum at +infinity and maximum at -infinity, so adding any point sets both corners
+BoundingBox::BoundingBox(){
+    minimum = Point(INFINITY, INFINITY, INFINITY);
+    maximum = Point(-INFINITY, -INFINITY, -INFINITY);
+}
+
+BoundingBox::BoundingBox(const Point &min, const Point &max){
+    minimum = min;
+    maximum = max;
+}
+
+// Getters
+const Point& BoundingBox::getMin() const{
+    return minimum;
+}
+
+const Point& BoundingBox::getMax() const{
+    return maximum;
+}
+
+// Box is empty if the minimum is larger than the maximum on any axis
+bool BoundingBox::isEmpty() const{
+    return minimum.x > maximum.x || minimum.y > maximum.y || minimum.z > maximum.z;
+}
+
+bool BoundingBox::isFinite() const{
+    return std::isfinite(minimum.x) && std::isfinite(minimum.y) && std::isfinite(minimum.z)
+        && std::isfinite(maximum.x) && std::isfinite(maximum.y) && std::isfinite(maximum.z);
+}
+
+// Grows the box to contain point p
+void BoundingBox::addPoint(const Point &p){
+    minimum = Point(std::min(minimum.x, p.x), std::min(minimum.y, p.y), std::min(minimum.z, p.z));
+    maximum = Point(std::max(maximum.x, p.x), std::max(maximum.y, p.y), std::max(maximum.z, p.z));
+}
+
+// Grows the box to contain box b
+void BoundingBox::merge(const BoundingBox &b){
+    if(b.isEmpty()){
+        return;
+    }
+    addPoint(b.getMin());
+    addPoint(b.getMax());
+}
+
+// Grows the box by d in every direction, used to cover floating point error at the box faces
+void BoundingBox::pad(float d){
+    if(isEmpty()){
+        return;
+    }
+    minimum = Point(minimum.x - d, minimum.y - d, minimum.z - d);
+    maximum = Point(maximum.x + d, maximum.y + d, maximum.z + d);
+}
+
+// Transforms all eight corners of the box by m and returns the box containing them
+BoundingBox BoundingBox::transform(const Matrix4 &m) const{
+    if(isEmpty()){
+        return BoundingBox();
+    }
+    // Multiplying infinite components by the matrix produces NaNs(infinity*0), so unbounded
+    // boxes conservatively become the box containing everything
+    if(!isFinite()){
+        return infiniteBoundingBox();
+    }
+
+    BoundingBox result;
+    for(int i = 0; i < 8; i++){
+        Point corner((i & 1) ? maximum.x : minimum.x, (i & 2) ? maximum.y : minimum.y, (i & 4) ? maximum.z : minimum.z);
+        result.addPoint(Point(m*corner));
+    }
+
+    return result;
+}
+
+// Center point of the box
+Point BoundingBox::centroid() const{
+    return Point((minimum.x + maximum.x)/2, (minimum.y + maximum.y)/2, (minimum.z + maximum.z)/2);
+}
+
+// Surface area of the box
+float BoundingBox::surfaceArea() const{
+    if(isEmpty()){
+        return 0;
+    }
+    Vector d = Vector(maximum - minimum);
+    return 2*(d.x*d.y + d.y*d.z + d.z*d.x);
+}
+
+// Slab test. For each axis, computes the times the ray enters and exits the space between the two
+// faces of the box on that axis. The ray passes through the box if the latest entry time is before
+// the earliest exit time
+bool BoundingBox::intersects(const Ray &r, float tMin, float tMax) const{
+    float tEnter;
+    return intersects(r, tMin, tMax, tEnter);
+}
+
+bool BoundingBox::intersects(const Ray &r, float tMin, float tMax, float &tEnter) const{
+    if(isEmpty()){
+        return false;
+    }
+
+    Point origin = r.getOrigin();
+    Vector direction = r.getDirection();
+    float o[3] = {origin.x, origin.y, origin.z};
+    float d[3] = {direction.x, direction.y, direction.z};
+    float lo[3] = {minimum.x, minimum.y, minimum.z};
+    float hi[3] = {maximum.x, maximum.y, maximum.z};
+
+    for(int axis = 0; axis < 3; axis++){
+        // Ray is parallel to the faces, only passes through if the origin is between them
+        if(d[axis] == 0){
+            if(o[axis] < lo[axis] || o[axis] > hi[axis]){
+                return false;
+            }
+            continue;
+        }
+
+        float t0 = (lo[axis] - o[axis])/d[axis];
+        float t1 = (hi[axis] - o[axis])/d[axis];
+        if(t0 > t1){
+            std::swap(t0, t1);
+        }
+
+        tMin = std::max(tMin, t0);
+        tMax = std::min(tMax, t1);
+        if(tMin > tMax){
+            return false;
+        }
+    }
+
+    tEnter = tMin;
+    return true;
+}
+
+// Box containing all of space
+BoundingBox infiniteBoundingBox(){
+    return BoundingBox(Point(-INFINITY, -INFINITY, -INFINITY), Point(INFINITY, INFINITY, INFINITY));
+}
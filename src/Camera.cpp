@@ -5,34 +5,40 @@ Camera::Camera(int h, int v, float fov){
     hsize = h;
     vsize = v;
     this->fov = fov;
-    transform = Matrix(4);
+    transform = Matrix4();
+    inverseTransform = Matrix4();
     computePixelSize();
 }
 
 // Getter variables for camera
-int Camera::getHSize(){
+int Camera::getHSize() const{
     return hsize;
 }
 
-int Camera::getVSize(){
+int Camera::getVSize() const{
     return vsize;
 }
 
-float Camera::getFOV(){
+float Camera::getFOV() const{
     return fov;
 }
 
-Matrix Camera::getTransform(){
+const Matrix4& Camera::getTransform() const{
     return transform;
 }
 
-float Camera::getPixelSize(){
+const Matrix4& Camera::getInverseTransform() const{
+    return inverseTransform;
+}
+
+float Camera::getPixelSize() const{
     return pixel_size;
 }
 
 // Setter variables for camera
-void Camera::setTransform(Matrix m){
+void Camera::setTransform(const Matrix4 &m){
     transform = m;
+    inverseTransform = m.inverse();
 }
 
 // Computes the size of a pixel in the units of the world eg. if the pixel size is 0.01 then 
@@ -62,7 +68,7 @@ void Camera::computePixelSize(){
 }
 
 // Computes a ray that starts at the camera and goes through the canvas at the specified xy pixel
-Ray Camera::rayToPixel(int x, int y){
+Ray Camera::rayToPixel(int x, int y) const{
     if(x < 0 || x >= hsize || y < 0 || y >= vsize){
         throw std::invalid_argument("rayToPixel xy invalid");
     }
@@ -80,26 +86,59 @@ Ray Camera::rayToPixel(int x, int y){
 
     // transforms the canvas point and camera origin to their
     // world positions
-    Point pixel = Point(transform.inverse()*Point(xWorld, yWorld, -1));
-    Point origin = Point(transform.inverse()*Point());
+    Point pixel = Point(inverseTransform*Point(xWorld, yWorld, -1));
+    Point origin = Point(inverseTransform*Point());
     Vector direction = Vector(pixel - origin).normalize();
 
     return Ray(origin, direction);
 }
 
 // Renders the world using the camera and world properties
-Canvas Camera::render(World w){
+Canvas Camera::render(World &w) const{
     Canvas image(hsize, vsize);
+    w.buildBVH();
     Ray r;
     Colour col;
 
+    RENDER_STAGE_TIMER(STAGE_TRACE);
     for(int y = 0; y < vsize; y++){
         for(int x = 0; x < hsize; x++){
+            RENDER_STAT(PRIMARY_RAYS);
             r = this->rayToPixel(x, y);
             col = w.colourAtHit(r);
             image.write_pixel(x, y, col);
         }
     }
 
+    return image;
+}
+
+// Renders the world in RENDER_TILE_SIZE x RENDER_TILE_SIZE tiles over a thread pool. Each pixel is only
+// written by the thread rendering its tile and the world is only read, so no locking is needed
+Canvas Camera::renderParallel(World &w, int threads) const{
+    Canvas image(hsize, vsize);
+    ThreadPool &pool = sharedThreadPool(threads);
+    // Built before the threads start, the BVH is only read while rendering
+    w.buildBVH();
+
+    int xTiles = (hsize + RENDER_TILE_SIZE - 1)/RENDER_TILE_SIZE;
+    int yTiles = (vsize + RENDER_TILE_SIZE - 1)/RENDER_TILE_SIZE;
+
+    RENDER_STAGE_TIMER(STAGE_TRACE);
+    pool.parallelFor(xTiles*yTiles, [&](int tile){
+        int xStart = (tile % xTiles)*RENDER_TILE_SIZE;
+        int yStart = (tile / xTiles)*RENDER_TILE_SIZE;
+        int xEnd = std::min(xStart + RENDER_TILE_SIZE, hsize);
+        int yEnd = std::min(yStart + RENDER_TILE_SIZE, vsize);
+
+        for(int y = yStart; y < yEnd; y++){
+            ColourSpan line = image.row(y);
+            for(int x = xStart; x < xEnd; x++){
+                RENDER_STAT(PRIMARY_RAYS);
+                line[x] = w.colourAtHit(this->rayToPixel(x, y));
+            }
+        }
+    });
+
     return image;
 }
\ No newline at end of file
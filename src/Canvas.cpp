@@ -4,7 +4,8 @@
 Canvas::Canvas(){
     width = DEFAULT_WIDTH;
     height = DEFAULT_HEIGHT;
-    pixels = std::vector<std::vector<Colour>>(height, std::vector<Colour> (width, Colour()));
+    stride = width;
+    pixels.assign(stride*height, Colour());
 }
 
 Canvas::Canvas(int w, int h){
@@ -20,7 +21,8 @@ Canvas::Canvas(int w, int h){
         height = h;
     }
 
-    pixels = std::vector<std::vector<Colour>>(height, std::vector<Colour> (width, Colour()));
+    stride = width;
+    pixels.assign(stride*height, Colour());
 }
 
 // Getters for width and height
@@ -32,106 +34,293 @@ int Canvas::getHeight(){
     return height;
 }
 
+int Canvas::getStride(){
+    return stride;
+}
+
 // Returns the colour of pixel at position [x][y]
 Colour Canvas::pixelColour(int x, int y){
-    return pixels.at(y).at(x);
+    if(x < 0 || x >= width || y < 0 || y >= height){
+        throw std::invalid_argument("pixelColour xy invalid");
+    }
+    return pixel(x, y);
 }
 
 // Updates the pixel colour at position [x][y]
 void Canvas::write_pixel(int x, int y, Colour c){
     if(x >= 0 && x < width && y >= 0 && y < height){
-        pixels[y][x] = c;
+        pixel(x, y) = c;
     }
 }
 
 // Sets all pixels to specified colour c
 void Canvas::setAllPixels(Colour c){
-    for(int y = 0; y < height; y++){
-        for(int x = 0; x < width; x++){
-            pixels[y][x] = c;
+    std::fill(pixels.begin(), pixels.end(), c);
+}
+
+// Returns a view of the width pixels in row y
+ColourSpan Canvas::row(int y){
+    if(y < 0 || y >= height){
+        throw std::invalid_argument("row y invalid");
+    }
+    return ColourSpan(pixels.data() + y*stride, width);
+}
+
+ColourSpan Canvas::pixelSpan(){
+    return ColourSpan(pixels.data(), pixels.size());
+}
+
+// Formats one row of the P3 body into out and returns the number of characters written. out must hold
+// at least PPM_MAX_CHARS_PER_PIXEL*width + 1 characters. Lines are wrapped before they pass PPM_LINE_LIMIT
+// characters and every row starts on a new line
+int formatPPMRow(ColourSpan line, char* out){
+    char* p = out;
+    int currChars = 0;
+
+    for(int x = 0; x < line.size(); x++){
+        int channels[3] = {quantizeChannel(line[x].r), quantizeChannel(line[x].g), quantizeChannel(line[x].b)};
+        for(int c = 0; c < 3; c++){
+            // Digits are written first and moved along if a separator is needed, so the length is only computed once
+            char digits[4];
+            int length = std::to_chars(digits, digits + sizeof(digits), channels[c]).ptr - digits;
+
+            if(currChars == 0){
+                currChars = length;
+            }else if(currChars + 1 + length > PPM_LINE_LIMIT){
+                *p++ = '\n';
+                currChars = length;
+            }else{
+                *p++ = ' ';
+                currChars += 1 + length;
+            }
+            std::memcpy(p, digits, length);
+            p += length;
         }
     }
+    *p++ = '\n';
+
+    return p - out;
 }
 
-// Converts canvas to ppm file
-std::string Canvas::toPPM(){
-    std::string file = "";
+// Converts canvas to ppm file. Blocks of PPM_ROWS_PER_TASK rows are formatted in parallel into their own
+// preallocated buffers and then copied into the file string in order
+std::string Canvas::toPPM(int threads){
+    // PPM identifier, width height and maximum colour value
+    std::string file = "P3\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+
+    int maxRowChars = PPM_MAX_CHARS_PER_PIXEL*width + 1;
+    int blocks = (height + PPM_ROWS_PER_TASK - 1)/PPM_ROWS_PER_TASK;
+    std::vector<std::vector<char>> blockText(blocks);
+    std::vector<int> blockLength(blocks, 0);
 
-    // PPM identifier
-    file += "P3\n";
+    ThreadPool &pool = sharedThreadPool(blocks == 1 ? 1 : threads);
+    pool.parallelFor(blocks, [&](int block){
+        int yStart = block*PPM_ROWS_PER_TASK;
+        int yEnd = std::min(yStart + PPM_ROWS_PER_TASK, height);
+        std::vector<char> &text = blockText.at(block);
+        text.resize(maxRowChars*(yEnd - yStart));
 
-    // width height
-    file += std::to_string(width) + " " + std::to_string(height) + "\n";
+        int length = 0;
+        for(int y = yStart; y < yEnd; y++){
+            length += formatPPMRow(row(y), text.data() + length);
+        }
+        blockLength.at(block) = length;
+    });
+
+    size_t headerLength = file.size();
+    size_t total = headerLength;
+    for(int i = 0; i < blocks; i++){
+        total += blockLength.at(i);
+    }
+    file.resize(total);
+
+    char* p = &file[headerLength];
+    for(int i = 0; i < blocks; i++){
+        std::memcpy(p, blockText.at(i).data(), blockLength.at(i));
+        p += blockLength.at(i);
+    }
 
-    // maximum colour value
-    file += "255\n";
+    return file;
+}
+
+// Writes the header and then quantizes each row into the buffer and writes it, so the file is never
+// held in memory as a whole
+void Canvas::writeP6(std::ostream &out, int maxval){
+    if(maxval < 1 || maxval > 65535){
+        throw std::invalid_argument("writeP6: maxval must be in [1, 65535]");
+    }
 
-    // Variables to help with limiting line length to 70 or less
-    Colour currPixel;
-    int currInt;
-    int currChars;
+    out << "P6\n" << width << " " << height << "\n" << maxval << "\n";
 
+    int bytesPerChannel = maxval > 255 ? 2 : 1;
+    std::vector<unsigned char> buffer(width*3*bytesPerChannel);
     for(int y = 0; y < height; y++){
-        currChars = 0;
+        ColourSpan line = row(y);
+        unsigned char* p = buffer.data();
         for(int x = 0; x < width; x++){
-            // Getting the current pixel
-            currPixel = this->pixelColour(x, y);
-
-            // Getting the r value for the pixel
-            currInt = ceil(std::min(currPixel.r, 1.0f)*255);
-            if(currInt < 0){
-                currInt = 0;
+            float channels[3] = {line[x].r, line[x].g, line[x].b};
+            for(int c = 0; c < 3; c++){
+                int value = quantizeChannel(channels[c], maxval);
+                if(bytesPerChannel == 2){
+                    *p++ = value >> 8;
+                }
+                *p++ = value & 0xFF;
             }
+        }
+        out.write(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    }
+}
 
-            // Checks if adding the current int to the string will character limit for current line
-            if(currChars + 1 + countDigits(currInt) > 70){
-                file += "\n" + std::to_string(currInt);
-                currChars = countDigits(currInt);
-            }else if(currChars == 0){
-                file += std::to_string(currInt);
-                currChars += countDigits(currInt);
-            }else{
-                file += " " + std::to_string(currInt);
-                currChars += 1 + countDigits(currInt);
-            }
+void Canvas::writeP6ToFile(std::string file_name, int maxval){
+    RENDER_STAGE_TIMER(STAGE_OUTPUT);
+    std::ofstream f(file_name, std::ios::binary);
+    writeP6(f, maxval);
+    f.close();
+}
 
-            // Getting the g value for the pixel
-            currInt = ceil(std::min(currPixel.g, 1.0f)*255);
-            if(currInt < 0){
-                currInt = 0;
-            }
+// Clamps c to [0, 1] and scales it to maxval
+int quantizeChannel(float c, int maxval){
+    int value = ceil(std::min(c, 1.0f)*maxval);
+    if(value < 0){
+        return 0;
+    }
+    return value;
+}
 
-            // Checks if adding the current int to the string will character limit for current line
-            if(currChars + 1 + countDigits(currInt) > 70){
-                file += "\n" + std::to_string(currInt);
-                currChars = countDigits(currInt);
-            }else{
-                file += " " + std::to_string(currInt);
-                currChars += 1 + countDigits(currInt);
+// PFM stores rows bottom to top, a negative scale marks little endian data
+void Canvas::writePFM(std::ostream &out){
+    static_assert(sizeof(Colour) == 3*sizeof(float), "Colour must be 3 packed floats to be written as PFM");
+    const uint16_t endianTest = 1;
+    bool littleEndian = *reinterpret_cast<const unsigned char*>(&endianTest) == 1;
+
+    out << "PF\n" << width << " " << height << "\n" << (littleEndian ? "-1.0" : "1.0") << "\n";
+    for(int y = height - 1; y >= 0; y--){
+        ColourSpan line = row(y);
+        out.write(reinterpret_cast<const char*>(line.data()), line.size()*sizeof(Colour));
+    }
+}
+
+void Canvas::writePFMToFile(std::string file_name){
+    RENDER_STAGE_TIMER(STAGE_OUTPUT);
+    std::ofstream f(file_name, std::ios::binary);
+    writePFM(f);
+    f.close();
+}
+
+// Scanlines 8 to 32767 pixels wide use the run length encoding, where each of the 4 components of the
+// row is encoded separately after a 4 byte marker. Other widths are written as flat RGBE pixels
+void Canvas::writeHDR(std::ostream &out){
+    out << "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " << height << " +X " << width << "\n";
+
+    bool encode = width >= 8 && width < 32768;
+    // Row of RGBE pixels split into its 4 components and the encoded output, reused for every row
+    std::vector<unsigned char> components(4*width);
+    std::vector<unsigned char> encoded(4 + 4*(width + (width + 127)/128));
+    for(int y = 0; y < height; y++){
+        ColourSpan line = row(y);
+        if(!encode){
+            for(int x = 0; x < width; x++){
+                colourToRGBE(line[x], &components[4*x]);
             }
+            out.write(reinterpret_cast<char*>(components.data()), components.size());
+            continue;
+        }
 
-            // Getting the b value for the pixel
-            currInt = ceil(std::min(currPixel.b, 1.0f)*255);
-            if(currInt < 0){
-                currInt = 0;
+        for(int x = 0; x < width; x++){
+            unsigned char rgbe[4];
+            colourToRGBE(line[x], rgbe);
+            for(int c = 0; c < 4; c++){
+                components[c*width + x] = rgbe[c];
             }
+        }
 
-            // Checks if adding the current int to the string will character limit for current line
-            if(currChars + 1 + countDigits(currInt) > 70){
-                file += "\n" + std::to_string(currInt);
-                currChars = countDigits(currInt);
-            }else{
-                file += " " + std::to_string(currInt);
-                currChars += 1 + countDigits(currInt);
+        unsigned char* p = encoded.data();
+        *p++ = 2;
+        *p++ = 2;
+        *p++ = width >> 8;
+        *p++ = width & 0xFF;
+        for(int c = 0; c < 4; c++){
+            p += encodeRGBERun(&components[c*width], width, p);
+        }
+        out.write(reinterpret_cast<char*>(encoded.data()), p - encoded.data());
+    }
+}
+
+void Canvas::writeHDRToFile(std::string file_name){
+    RENDER_STAGE_TIMER(STAGE_OUTPUT);
+    std::ofstream f(file_name, std::ios::binary);
+    writeHDR(f);
+    f.close();
+}
+
+// The largest channel sets the exponent, negative channels are clamped to 0
+void colourToRGBE(Colour c, unsigned char rgbe[4]){
+    float r = std::max(c.r, 0.0f);
+    float g = std::max(c.g, 0.0f);
+    float b = std::max(c.b, 0.0f);
+    float v = std::max({r, g, b});
+
+    if(v < 1e-32){
+        rgbe[0] = rgbe[1] = rgbe[2] = rgbe[3] = 0;
+        return;
+    }
+
+    int e;
+    float scale = frexp(v, &e)*256.0f/v;
+    rgbe[0] = r*scale;
+    rgbe[1] = g*scale;
+    rgbe[2] = b*scale;
+    rgbe[3] = e + 128;
+}
+
+// Runs of 4 or more equal bytes are written as (128 + length, value), everything between runs is written
+// as (length, bytes...). Lengths are limited to 127 for runs and 128 for literal bytes
+int encodeRGBERun(const unsigned char* data, int n, unsigned char* out){
+    unsigned char* p = out;
+    int cur = 0;
+
+    while(cur < n){
+        // Find the start of the next run of at least 4 equal bytes
+        int runStart = cur;
+        int runLength = 0;
+        int previousRunLength = 0;
+        while(runLength < 4 && runStart < n){
+            runStart += runLength;
+            previousRunLength = runLength;
+            runLength = 1;
+            while(runStart + runLength < n && runLength < 127 && data[runStart] == data[runStart + runLength]){
+                runLength++;
             }
         }
-        file += "\n";
+
+        // A short run of 2 or 3 bytes right at cur is still cheaper as a run
+        if(previousRunLength > 1 && previousRunLength == runStart - cur){
+            *p++ = 128 + previousRunLength;
+            *p++ = data[cur];
+            cur = runStart;
+        }
+
+        // Literal bytes up to the run
+        while(cur < runStart){
+            int count = std::min(128, runStart - cur);
+            *p++ = count;
+            std::memcpy(p, data + cur, count);
+            p += count;
+            cur += count;
+        }
+
+        if(runLength >= 4){
+            *p++ = 128 + runLength;
+            *p++ = data[runStart];
+            cur += runLength;
+        }
     }
 
-    return file;
+    return p - out;
 }
 
 void Canvas::writeToFile(std::string file_name){
+    RENDER_STAGE_TIMER(STAGE_OUTPUT);
     std::ofstream f(file_name);
     std::string ppm_string = this->toPPM();
     // Write to the file
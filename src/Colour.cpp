@@ -17,7 +17,7 @@ Colour::Colour(float r, float g, float b){
 }
 
 // Checks if two colours are equal
-bool Colour::isEqual(Colour a){
+bool Colour::isEqual(const Colour &a) const{
     if(!floatIsEqual(r, a.r) || !floatIsEqual(g, a.g) || !floatIsEqual(b, a.b)){
         return false;
     }
@@ -26,22 +26,22 @@ bool Colour::isEqual(Colour a){
 
 // Colour operations, works the same as tuple operations
 // Returns the colour this + a
-Colour Colour::operator+(Colour a){
+Colour Colour::operator+(const Colour &a) const{
     return Colour(r + a.r, g + a.g, b + a.b);
 }
 
 // Returns the colour this - a
-Colour Colour::operator-(Colour a){
+Colour Colour::operator-(const Colour &a) const{
     return Colour(r - a.r, g - a.g, b - a.b);
 }
 
 // Returns the colour this*scale
-Colour Colour::operator*(float scale){
+Colour Colour::operator*(float scale) const{
     return Colour(r*scale, g*scale, b*scale);
 }
 
 // Hadamard product(this * a). Conceptually the combination of viewing one colour under
 // a coloured light
-Colour Colour::operator*(Colour a){
+Colour Colour::operator*(const Colour &a) const{
     return Colour(r*a.r, g*a.g, b*a.b);
 }
\ No newline at end of file
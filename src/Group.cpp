@@ -1,6 +1,6 @@
 #include "Group.h"
 
-std::vector<Shape*> Group::getShapes(){
+const std::vector<Shape*>& Group::getShapes() const{
     return shapes;
 }
 
@@ -9,17 +9,44 @@ void Group::appendShape(Shape* s){
     s->setParent(this);
 }
 
-std::vector<Intersection> Group::childIntersections(Ray r){
-    std::vector<Intersection> intersects;
-    std::vector<Intersection> temp;
+// Merges the bounds of all shapes in the group, the shapes' bounds are already in the group's space
+BoundingBox Group::childBounds(){
+    BoundingBox bounds;
+    for(int i = 0; i < shapes.size(); i++){
+        bounds.merge(shapes.at(i)->getBounds());
+    }
+
+    return bounds;
+}
+
+// Appends the intersections of every shape in the group, the group's intersections are sorted by time
+void Group::childIntersections(const Ray &r, std::vector<Intersection> &intersects){
+    RENDER_INTERSECTION_STAT(GROUP_TESTS, GROUP_HITS, intersects);
+    int start = intersects.size();
 
     for(int i = 0; i < shapes.size(); i++){
-        temp = shapes.at(i)->findIntersections(r);
-        for(int j = 0; j < temp.size(); j++){
-            intersects.push_back(temp.at(j));
-        }
+        shapes.at(i)->findIntersections(r, intersects);
     }
 
-    std::sort(intersects.begin(), intersects.end(), compareIntersections);
-    return intersects;
-}
\ No newline at end of file
+    std::sort(intersects.begin() + start, intersects.end(), compareIntersections);
+}
+
+// Flattens the group, every shape below it is committed with the group's world matrices as its parent's
+void Group::commitTransforms(const Matrix4 &parentTransform, const Matrix4 &parentInverse, std::vector<Shape*> &primitives){
+    worldTransform = parentTransform*transform;
+    worldInverse = inverseTransform*parentInverse;
+    worldInverseTranspose = worldInverse.transpose();
+    worldCommitted = true;
+
+    for(int i = 0; i < shapes.size(); i++){
+        shapes.at(i)->commitTransforms(worldTransform, worldInverse, primitives);
+    }
+}
+
+// Every shape below the group has the group's transform in its world matrices
+void Group::invalidateWorldTransforms(){
+    Shape::invalidateWorldTransforms();
+    for(int i = 0; i < shapes.size(); i++){
+        shapes.at(i)->invalidateWorldTransforms();
+    }
+}
@@ -2,21 +2,26 @@
 #include "Shape.h"
 
 // Intersection constructor
-Intersection::Intersection(float t, Shape* s){
+Intersection::Intersection(float t, Shape* s, int index){
     time = t;
+    this->index = index;
     this->s = s;
 }
 
 // Getters for Intersection variables
-float Intersection::getTime(){
+float Intersection::getTime() const{
     return time;
 }
 
-Shape* Intersection::getShape(){
+Shape* Intersection::getShape() const{
     return s;
 }
 
-bool Intersection::isEqual(Intersection i){
+int Intersection::getIndex() const{
+    return index;
+}
+
+bool Intersection::isEqual(const Intersection &i) const{
     return floatIsEqual(time, i.getTime()) && s == i.getShape();
 }
 
@@ -26,7 +31,7 @@ std::vector<Intersection> intersections(std::initializer_list<Intersection> l){
 }
 
 // Finds the intersection with the lowest non-negative time in the vector
-int hit(std::vector<Intersection> vec){
+int hit(const std::vector<Intersection> &vec){
     int ind = -1;
     float t = INFINITY;
     for(int i = 0; i < vec.size(); i++){
@@ -41,6 +46,6 @@ int hit(std::vector<Intersection> vec){
 
 // Compares intersections and returns the intersection with the lower time
 // Used for std::sort function
-bool compareIntersections(Intersection a, Intersection b){
+bool compareIntersections(const Intersection &a, const Intersection &b){
     return a.getTime() < b.getTime();
 }
\ No newline at end of file
@@ -3,7 +3,7 @@
 // Computes reflection vector of an input vector bouncing
 // off a point on  surface where the parameter normal is
 // the normal vector of the surface at that point
-Vector reflectVector(Vector input, Vector normal){
+Vector reflectVector(const Vector &input, const Vector &normal){
     return Vector(input - normal*2*dotProduct(input, normal));
 }
 
@@ -13,22 +13,22 @@ LightSource::LightSource(){
     intensity = Colour(0, 0, 0);
 }
 
-LightSource::LightSource(Point p, Colour i){
+LightSource::LightSource(const Point &p, const Colour &i){
     position = p;
     intensity = i;
 }
 
 // Light source getters
-Point LightSource::getPosition(){
+const Point& LightSource::getPosition() const{
     return position;
 }
 
-Colour LightSource::getIntensity(){
+const Colour& LightSource::getIntensity() const{
     return intensity;
 }
 
 // Equality function
-bool LightSource::isEqual(LightSource l){
+bool LightSource::isEqual(const LightSource &l) const{
     return position.isEqual(l.getPosition()) && intensity.isEqual(l.getIntensity());
 }
 
@@ -47,7 +47,7 @@ Material::Material(){
 }
 
 // Material equality checker
-bool Material::isEqual(Material m){
+bool Material::isEqual(const Material &m) const{
     if(!colour.isEqual(m.colour)){
         return false;
     }
@@ -80,7 +80,7 @@ bool Material::isEqual(Material m){
 }
 
 // Calculates the updated colour value of a point based on the ray, light, and object/material attributes
-Colour computeLighting(Material m, Shape* object, LightSource l, Point p, Vector camera, Vector normal, bool inShadow){
+Colour computeLighting(const Material &m, Shape* object, const LightSource &l, const Point &p, const Vector &camera, const Vector &normal, bool inShadow){
     Colour colour;
     if(m.pattern == nullptr){
         colour = m.colour;
@@ -1,21 +1,61 @@
 #include "LightData.h"
+#include <cstdint>
+
+// Hash table from a shape to its position in the stack of findRefractiveIndices, -1 once the ray has left
+// it. Uses open addressing over storage kept between walks, so after the first few walks on a thread it
+// doesn't allocate. A shape stays in the table for the rest of the walk, so no slot is ever removed
+struct ContainerPositions{
+    std::vector<Shape*> keys;
+    std::vector<int> positions;
+    // Slots filled during the current walk, emptied by reset
+    std::vector<int> used;
+
+    // Empties the table and makes room for the distinct shapes of a walk over count intersections, the
+    // table is kept at least half empty so probes stay short
+    void reset(size_t count){
+        size_t capacity = keys.empty() ? 16 : keys.size();
+        while(capacity < 2*count){
+            capacity *= 2;
+        }
+        if(capacity != keys.size()){
+            keys.assign(capacity, nullptr);
+            positions.assign(capacity, -1);
+        }else{
+            for(int a = 0; a < used.size(); a++){
+                keys[used[a]] = nullptr;
+            }
+        }
+        used.clear();
+    }
+
+    // Position of the shape, a shape seen for the first time is added with position -1
+    int& at(Shape* s){
+        size_t mask = keys.size() - 1;
+        size_t slot = ((uintptr_t)s >> 4)*0x9E3779B97F4A7C15ull & mask;
+        while(keys[slot] != nullptr && keys[slot] != s){
+            slot = (slot + 1) & mask;
+        }
+        if(keys[slot] == nullptr){
+            keys[slot] = s;
+            positions[slot] = -1;
+            used.push_back(slot);
+        }
+        return positions[slot];
+    }
+};
 
 // Light data constructor
 LightData::LightData(){
-    object = new Sphere;
+    object = nullptr;
     time = 0;
-    point = Point();
-    camera = Vector();
-    normal = Vector();
-    reflect = Vector();
     insideObject = false;
-    overPoint = point + normal*EPSILON;
     n1 = 1;
     n2 = 1;
 }
 
 // Packs the data required for the computeLighting function into the LightData data structure
-LightData prepareLightData(Intersection i, Ray r, std::vector<Intersection> rayIntersects){
+LightData prepareLightData(const Intersection &i, const Ray &r, const std::vector<Intersection> &rayIntersects){
+    RENDER_STAT(PREPARE_LIGHT_DATA_CALLS);
     LightData data;
 
     data.time = i.getTime();
@@ -23,68 +63,74 @@ LightData prepareLightData(Intersection i, Ray r, std::vector<Intersection> rayI
 
     data.point = r.computePosition(data.time);
     data.camera = Vector(r.getDirection().negateTuple());
-    data.normal = data.object->computeNormal(data.point);
+    data.normal = data.object->computeNormal(data.point, i);
 
     if(dotProduct(data.normal, data.camera) < 0){
         data.insideObject = true;
         data.normal = Vector(data.normal.negateTuple());
     }
 
-    data.reflect = reflectVector(r.getDirection(), data.normal);
     data.overPoint = data.point + data.normal*EPSILON;
-    data.underPoint = data.point - data.normal*EPSILON;
 
-    findRefractiveIndices(data, i, rayIntersects);
+    // Most hits are on opaque, non reflective surfaces which only need the fields above
+    const Material &m = data.object->getMaterial();
+    if(m.reflective > 0){
+        data.reflect = reflectVector(r.getDirection(), data.normal);
+    }
+    if(m.transparency > 0){
+        data.underPoint = data.point - data.normal*EPSILON;
+        findRefractiveIndices(data, i, rayIntersects);
+    }
 
     return data;
 }
 
 // Algorithm for computing the refractive indices of the material being exited and the material being entered
-void findRefractiveIndices(LightData &data, Intersection i, std::vector<Intersection> rayIntersects){
-    std::vector<Shape*> containers;
+// Walks the sorted intersections up to the hit, keeping a stack of the objects the ray is inside together
+// with their refractive index, so the materials are only read once when an object is entered.
+// The position of each object in the stack is kept in a hash table, an object that is left is marked as no
+// longer inside and only popped once it reaches the top. Every intersection is then handled in constant
+// time, so the walk is O(n) however deeply the objects are nested
+void findRefractiveIndices(LightData &data, const Intersection &i, const std::vector<Intersection> &rayIntersects){
+    // Reused between calls so only the first few transparent hits on a thread allocate
+    static thread_local std::vector<RefractiveContainer> containers;
+    static thread_local ContainerPositions positions;
+    containers.clear();
+    positions.reset(rayIntersects.size());
 
     for(int a = 0; a < rayIntersects.size(); a++){
-        // if the current index is the hit
-        if(rayIntersects.at(a).isEqual(i)){
-            // Ray is not currently in any object
-            if(containers.empty()){
-                data.n1 = 1.0;
-            }else{
-                // n1 refractive index is set to the last shape's material in containers because the ray is exiting that shape
-                data.n1 = containers.back()->getMaterial().refractiveIndex;
-            }
+        const Intersection &current = rayIntersects.at(a);
+        bool isHit = current.isEqual(i);
+        if(isHit){
+            // n1 is the refractive index of the innermost object the ray is in before the hit, 1 if it is not in any
+            data.n1 = containers.empty() ? 1.0 : containers.back().refractiveIndex;
         }
 
-        bool enteredObject = false;
-        int b;
-        for(b = 0; b < containers.size(); b++){
-            if(rayIntersects.at(a).getShape() == containers.at(b)){
-                enteredObject = true;
-                break;
+        // The top of the stack is always an object the ray is still inside
+        int &position = positions.at(current.getShape());
+        if(position >= 0){
+            containers[position].inside = false;
+            position = -1;
+            while(!containers.empty() && !containers.back().inside){
+                containers.pop_back();
             }
-        }
-
-        if(enteredObject){
-            containers.erase(containers.begin() + b);
         }else{
-            containers.push_back(rayIntersects.at(a).getShape());
+            position = containers.size();
+            containers.push_back({current.getShape(), current.getShape()->getMaterial().refractiveIndex, true});
         }
 
-        if(rayIntersects.at(a).isEqual(i)){
-            // Ray is not currently in any object
-            if(containers.empty()){
-                data.n2 = 1.0;
-            }else{
-                // n2 refractive index is set to the refractive index of the last shape that was entered
-                data.n2 = containers.back()->getMaterial().refractiveIndex;
-            }
+        if(isHit){
+            // n2 is the refractive index of the innermost object the ray is in after the hit
+            data.n2 = containers.empty() ? 1.0 : containers.back().refractiveIndex;
+            // Intersections after the hit do not affect either index
+            return;
         }
     }
 }
 
 // Approximates Fresnel Effect using Schlick's approximation
 // Refer to "Reflections and Refractions in Ray Tracing" by Bram de Greve
-float schlickApproximation(LightData data){
+float schlickApproximation(const LightData &data){
     // cosine of the angle between camera and normal vector
     float cos = dotProduct(data.camera, data.normal);
 
@@ -0,0 +1,116 @@
+#include "MaterialRegistry.h"
+#include <stdexcept>
+#include <string>
+
+// Registry constructor, the default material is registered for good and shapes using it hold no reference
+MaterialRegistry::MaterialRegistry(){
+    materials.push_back(Material());
+    slots.push_back({true, 0});
+}
+
+// Reuses a released slot if there is one
+MaterialID MaterialRegistry::addLocked(const Material &m, const Slot &slot){
+    if(!freeIDs.empty()){
+        MaterialID id = freeIDs.back();
+        freeIDs.pop_back();
+        materials[id] = m;
+        slots[id] = slot;
+        return id;
+    }
+
+    materials.push_back(m);
+    slots.push_back(slot);
+    return materials.size() - 1;
+}
+
+bool MaterialRegistry::inUseLocked(MaterialID id) const{
+    if(id < 0 || id >= slots.size()){
+        return false;
+    }
+    return slots[id].registered || slots[id].shapes > 0;
+}
+
+void MaterialRegistry::freeIfUnusedLocked(MaterialID id){
+    if(!slots[id].registered && slots[id].shapes == 0){
+        materials[id] = Material();
+        freeIDs.push_back(id);
+    }
+}
+
+MaterialID MaterialRegistry::add(const Material &m){
+    std::lock_guard<std::mutex> guard(lock);
+    return addLocked(m, {true, 0});
+}
+
+MaterialID MaterialRegistry::addForShape(const Material &m){
+    std::lock_guard<std::mutex> guard(lock);
+    return addLocked(m, {false, 1});
+}
+
+// Called for every shaded hit so the ID is not range checked, IDs only come from add
+const Material& MaterialRegistry::get(MaterialID id) const{
+    return materials[id];
+}
+
+Material MaterialRegistry::copy(MaterialID id) const{
+    std::lock_guard<std::mutex> guard(lock);
+    if(!inUseLocked(id)){
+        throw std::invalid_argument("MaterialRegistry::copy - Invalid material ID: " + std::to_string(id));
+    }
+    return materials[id];
+}
+
+void MaterialRegistry::set(MaterialID id, const Material &m){
+    std::lock_guard<std::mutex> guard(lock);
+    if(!inUseLocked(id)){
+        throw std::invalid_argument("MaterialRegistry::set - Invalid material ID: " + std::to_string(id));
+    }
+    materials[id] = m;
+}
+
+// Only a registration can be released here, a slot used by a shape is freed by its last shape
+void MaterialRegistry::release(MaterialID id){
+    std::lock_guard<std::mutex> guard(lock);
+    if(id == DEFAULT_MATERIAL || !inUseLocked(id) || !slots[id].registered){
+        throw std::invalid_argument("MaterialRegistry::release - Invalid material ID: " + std::to_string(id));
+    }
+    slots[id].registered = false;
+    freeIfUnusedLocked(id);
+}
+
+// The default material is never freed, so shapes using it hold no reference
+void MaterialRegistry::retain(MaterialID id){
+    std::lock_guard<std::mutex> guard(lock);
+    if(!inUseLocked(id)){
+        throw std::invalid_argument("MaterialRegistry::retain - Invalid material ID: " + std::to_string(id));
+    }
+    if(id != DEFAULT_MATERIAL){
+        slots[id].shapes++;
+    }
+}
+
+void MaterialRegistry::releaseForShape(MaterialID id){
+    std::lock_guard<std::mutex> guard(lock);
+    if(id == DEFAULT_MATERIAL || id < 0 || id >= slots.size() || slots[id].shapes == 0){
+        return;
+    }
+    slots[id].shapes--;
+    freeIfUnusedLocked(id);
+}
+
+int MaterialRegistry::size() const{
+    std::lock_guard<std::mutex> guard(lock);
+    return materials.size() - freeIDs.size();
+}
+
+bool MaterialRegistry::contains(MaterialID id) const{
+    std::lock_guard<std::mutex> guard(lock);
+    return inUseLocked(id) && slots[id].registered;
+}
+
+// Constructed on first use and never destroyed, so shapes created or destroyed during static
+// initialisation and destruction can still use it
+MaterialRegistry& materialRegistry(){
+    static MaterialRegistry* registry = new MaterialRegistry;
+    return *registry;
+}
@@ -55,14 +55,27 @@ Matrix::Matrix(int r, int c, std::vector<std::vector<float>> vec){
     }
 
     if(valid){
-        matrix = vec;
+        matrix = std::move(vec);
     }else{
         matrix = std::vector<std::vector<float>>(rows, std::vector<float> (cols, 0));
     }
 }
 
+// Constructor from a fixed size 4x4 matrix
+Matrix::Matrix(const Matrix4 &m){
+    rows = 4;
+    cols = 4;
+
+    matrix = std::vector<std::vector<float>>(rows, std::vector<float> (cols, 0));
+    for(int r = 0; r < rows; r++){
+        for(int c = 0; c < cols; c++){
+            matrix[r][c] = m.getElement(r, c);
+        }
+    }
+}
+
 // Checks if given xy coordinates are within range of the matrix dimensions
-bool Matrix::checkCoordValid(int x, int y){
+bool Matrix::checkCoordValid(int x, int y) const{
     if(x > -1 && y > -1 && x < rows && y < cols){
         return true;
     }
@@ -70,17 +83,17 @@ bool Matrix::checkCoordValid(int x, int y){
 }
 
 // Getter for rows
-int Matrix::getRows(){
+int Matrix::getRows() const{
     return rows;
 }
 
 // Getter for cols
-int Matrix::getCols(){
+int Matrix::getCols() const{
     return cols;
 }
 
 // Getter for element at coord xy
-float Matrix::getElement(int x, int y){
+float Matrix::getElement(int x, int y) const{
     if(this->checkCoordValid(x, y)){
         return matrix.at(x).at(y);
     }else{
@@ -98,12 +111,12 @@ void Matrix::setElement(int x, int y, float val){
 }
 
 // Matrix getter
-std::vector<std::vector<float>> Matrix::getMatrix(){
+const std::vector<std::vector<float>>& Matrix::getMatrix() const{
     return matrix;
 }
 
 // Converts matrix to string
-std::string Matrix::toString(){
+std::string Matrix::toString() const{
     std::string s = "";
     for(int r = 0; r < rows; r++){
         s += "[";
@@ -117,7 +130,7 @@ std::string Matrix::toString(){
 }
 
 // Matrix equality check
-bool Matrix::isEqual(Matrix a){
+bool Matrix::isEqual(const Matrix &a) const{
     if(rows != a.getRows() || cols != a.getCols()){
         return false;
     }
@@ -133,7 +146,7 @@ bool Matrix::isEqual(Matrix a){
 }
 
 // Matrix multiplication
-Matrix Matrix::operator*(Matrix m2){
+Matrix Matrix::operator*(const Matrix &m2) const{
     // Invalid matrix multiplication
     if(cols != m2.getRows()){
         throw std::invalid_argument("Invalid matrix dimensions");
@@ -159,7 +172,7 @@ Matrix Matrix::operator*(Matrix m2){
 }
 
 // Matrix multiplication with vector
-Tuple Matrix::operator*(Tuple m2){
+Tuple Matrix::operator*(const Tuple &m2) const{
     // Invalid matrix multiplication
     if(cols != 4){
         throw std::invalid_argument("multiplyMatrixTuple: Invalid matrix dimensions");
@@ -183,7 +196,7 @@ Tuple Matrix::operator*(Tuple m2){
 }
 
 // Computes the transpose of the matrix
-Matrix Matrix::transpose(){
+Matrix Matrix::transpose() const{
     Matrix m(cols, rows);
 
     for(int r = 0; r < rows; r++){
@@ -196,7 +209,7 @@ Matrix Matrix::transpose(){
 }
 
 // Computes determinant for a 2x2 matrix
-float Matrix::twoDet(){
+float Matrix::twoDet() const{
     if(rows != 2 || cols != 2){
         throw std::invalid_argument("twoDet: Invalid matrix dimensions");
     }
@@ -208,7 +221,7 @@ float Matrix::twoDet(){
 }
 
 // Computes submatrix that is generated when removing the xth row and yth column(For computing determinants)
-Matrix Matrix::submatrix(int x, int y){
+Matrix Matrix::submatrix(int x, int y) const{
     if(!this->checkCoordValid(x, y)){
         throw std::invalid_argument("submatrix: Invalid xy coords");
     }else if(rows == 1 && cols == 1){
@@ -226,7 +239,7 @@ Matrix Matrix::submatrix(int x, int y){
 
 // Computes the minor of the matrix given coords xy
 // Minor is defined as the determinant of the submatrix without row x and col y
-float Matrix::minor(int x, int y){
+float Matrix::minor(int x, int y) const{
     if(rows != cols || rows == 1 || rows == 2){
         throw std::invalid_argument("minor: matrix dimensions invalid");
     }
@@ -236,7 +249,7 @@ float Matrix::minor(int x, int y){
 
 // Computes the cofactor of the matrix given coords xy
 // Cofactor is the minor but negated if x + y == odd number
-float Matrix::cofactor(int x, int y){
+float Matrix::cofactor(int x, int y) const{
     if((x + y) % 2 == 1){
         return -1*this->minor(x, y);
     }else{
@@ -245,7 +258,7 @@ float Matrix::cofactor(int x, int y){
 }
 
 // Calculates determinant of matrix
-float Matrix::determinant(){
+float Matrix::determinant() const{
     if(rows != cols || rows == 1){
         throw std::invalid_argument("determinant: Matrix too small or not square matrix");
     }
@@ -264,7 +277,7 @@ float Matrix::determinant(){
 }
 
 // Checks if the matrix is invertable
-bool Matrix::isInvertable(){
+bool Matrix::isInvertable() const{
     // Checks if matrix is square and not 1x1
     if(rows != cols || rows == 1){
         return false;
@@ -275,7 +288,8 @@ bool Matrix::isInvertable(){
 
 // Computes inverse of matrix
 // Element [r, c] = cofactor(c, r)/det
-Matrix Matrix::inverse(){
+Matrix Matrix::inverse() const{
+    RENDER_STAT(MATRIX_INVERSIONS);
     if(!this->isInvertable()){
         throw std::invalid_argument("inverse: Matrix is not invertable\n" + toString());
     }
@@ -292,6 +306,249 @@ Matrix Matrix::inverse(){
     return m;
 }
 
+// Matrix4 constructors
+// Default constructor generates the 4x4 identity matrix
+Matrix4::Matrix4(){
+    for(int r = 0; r < 4; r++){
+        for(int c = 0; c < 4; c++){
+            matrix[r][c] = (r == c) ? 1 : 0;
+        }
+    }
+}
+
+// Constructor from a general matrix, only valid if the matrix is 4x4
+Matrix4::Matrix4(const Matrix &m){
+    if(m.getRows() != 4 || m.getCols() != 4){
+        throw std::invalid_argument("Matrix4: matrix is not 4x4");
+    }
+
+    for(int r = 0; r < 4; r++){
+        for(int c = 0; c < 4; c++){
+            matrix[r][c] = m.getElement(r, c);
+        }
+    }
+}
+
+// Checks if given xy coordinates are within range of a 4x4 matrix
+bool Matrix4::checkCoordValid(int x, int y) const{
+    if(x > -1 && y > -1 && x < 4 && y < 4){
+        return true;
+    }
+    return false;
+}
+
+// Getter for element at coord xy
+float Matrix4::getElement(int x, int y) const{
+    if(this->checkCoordValid(x, y)){
+        return matrix[x][y];
+    }else{
+        throw std::invalid_argument("getElement: received invalid xy coordinates [" + std::to_string(x) + ", " + std::to_string(y) + "]");
+    }
+}
+
+// Sets element in matrix at coord xy to val
+void Matrix4::setElement(int x, int y, float val){
+    if(this->checkCoordValid(x, y)){
+        matrix[x][y] = val;
+    }else{
+        throw std::invalid_argument("setElement: received invalid xy coordinates [" + std::to_string(x) + ", " + std::to_string(y) + "]");
+    }
+}
+
+// Converts matrix to string
+std::string Matrix4::toString() const{
+    std::string s = "";
+    for(int r = 0; r < 4; r++){
+        s += "[";
+        for(int c = 0; c < 4; c++){
+            s += std::to_string(matrix[r][c]) + " ";
+        }
+        s += "]\n";
+    }
+
+    return s;
+}
+
+// Matrix equality check
+bool Matrix4::isEqual(const Matrix4 &a) const{
+    for(int r = 0; r < 4; r++){
+        for(int c = 0; c < 4; c++){
+            if(!floatIsEqual(matrix[r][c], a.matrix[r][c])){
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Matrix multiplication, the elements are accessed directly since the dimensions are always valid
+Matrix4 Matrix4::operator*(const Matrix4 &m2) const{
+    Matrix4 m;
+    for(int r = 0; r < 4; r++){
+        for(int c = 0; c < 4; c++){
+            m.matrix[r][c] = matrix[r][0]*m2.matrix[0][c] + matrix[r][1]*m2.matrix[1][c]
+                           + matrix[r][2]*m2.matrix[2][c] + matrix[r][3]*m2.matrix[3][c];
+        }
+    }
+
+    return m;
+}
+
+// Matrix multiplication with tuple
+Tuple Matrix4::operator*(const Tuple &m2) const{
+#ifdef TUPLE_SIMD
+    // Multiplies each row by the tuple, then transposes the products so that adding the
+    // four registers together sums each row's products into its own lane
+    __m128 t = m2.toSIMD();
+    __m128 r0 = _mm_mul_ps(_mm_load_ps(matrix[0]), t);
+    __m128 r1 = _mm_mul_ps(_mm_load_ps(matrix[1]), t);
+    __m128 r2 = _mm_mul_ps(_mm_load_ps(matrix[2]), t);
+    __m128 r3 = _mm_mul_ps(_mm_load_ps(matrix[3]), t);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    return Tuple(_mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3)));
+#else
+    return Tuple(matrix[0][0]*m2.x + matrix[0][1]*m2.y + matrix[0][2]*m2.z + matrix[0][3]*m2.point,
+                 matrix[1][0]*m2.x + matrix[1][1]*m2.y + matrix[1][2]*m2.z + matrix[1][3]*m2.point,
+                 matrix[2][0]*m2.x + matrix[2][1]*m2.y + matrix[2][2]*m2.z + matrix[2][3]*m2.point,
+                 matrix[3][0]*m2.x + matrix[3][1]*m2.y + matrix[3][2]*m2.z + matrix[3][3]*m2.point);
+#endif
+}
+
+// Computes the transpose of the matrix
+Matrix4 Matrix4::transpose() const{
+    Matrix4 m;
+    for(int r = 0; r < 4; r++){
+        for(int c = 0; c < 4; c++){
+            m.matrix[c][r] = matrix[r][c];
+        }
+    }
+
+    return m;
+}
+
+// Calculates determinant of matrix. Expands along the top two rows using the 2x2 determinants
+// of the top two rows(s) and bottom two rows(c), which is the same result as the cofactor expansion
+// without building any submatrices
+float Matrix4::determinant() const{
+    float s0 = matrix[0][0]*matrix[1][1] - matrix[1][0]*matrix[0][1];
+    float s1 = matrix[0][0]*matrix[1][2] - matrix[1][0]*matrix[0][2];
+    float s2 = matrix[0][0]*matrix[1][3] - matrix[1][0]*matrix[0][3];
+    float s3 = matrix[0][1]*matrix[1][2] - matrix[1][1]*matrix[0][2];
+    float s4 = matrix[0][1]*matrix[1][3] - matrix[1][1]*matrix[0][3];
+    float s5 = matrix[0][2]*matrix[1][3] - matrix[1][2]*matrix[0][3];
+
+    float c5 = matrix[2][2]*matrix[3][3] - matrix[3][2]*matrix[2][3];
+    float c4 = matrix[2][1]*matrix[3][3] - matrix[3][1]*matrix[2][3];
+    float c3 = matrix[2][1]*matrix[3][2] - matrix[3][1]*matrix[2][2];
+    float c2 = matrix[2][0]*matrix[3][3] - matrix[3][0]*matrix[2][3];
+    float c1 = matrix[2][0]*matrix[3][2] - matrix[3][0]*matrix[2][2];
+    float c0 = matrix[2][0]*matrix[3][1] - matrix[3][0]*matrix[2][1];
+
+    return s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+}
+
+// Checks if the matrix is invertable
+bool Matrix4::isInvertable() const{
+    return !floatIsEqual(this->determinant(), 0.0f);
+}
+
+// Checks if the bottom row is 0, 0, 0, 1. Every translation, scaling, rotation and shearing
+// matrix and any product of them is affine
+bool Matrix4::isAffine() const{
+    return matrix[3][0] == 0 && matrix[3][1] == 0 && matrix[3][2] == 0 && matrix[3][3] == 1;
+}
+
+// Computes inverse of matrix. Affine matrices use inverseAffine, every other matrix
+// uses the closed form adjugate built from the same 2x2 determinants as determinant()
+Matrix4 Matrix4::inverse() const{
+    RENDER_STAT(MATRIX_INVERSIONS);
+    if(isAffine()){
+        return inverseAffine();
+    }
+
+    float s0 = matrix[0][0]*matrix[1][1] - matrix[1][0]*matrix[0][1];
+    float s1 = matrix[0][0]*matrix[1][2] - matrix[1][0]*matrix[0][2];
+    float s2 = matrix[0][0]*matrix[1][3] - matrix[1][0]*matrix[0][3];
+    float s3 = matrix[0][1]*matrix[1][2] - matrix[1][1]*matrix[0][2];
+    float s4 = matrix[0][1]*matrix[1][3] - matrix[1][1]*matrix[0][3];
+    float s5 = matrix[0][2]*matrix[1][3] - matrix[1][2]*matrix[0][3];
+
+    float c5 = matrix[2][2]*matrix[3][3] - matrix[3][2]*matrix[2][3];
+    float c4 = matrix[2][1]*matrix[3][3] - matrix[3][1]*matrix[2][3];
+    float c3 = matrix[2][1]*matrix[3][2] - matrix[3][1]*matrix[2][2];
+    float c2 = matrix[2][0]*matrix[3][3] - matrix[3][0]*matrix[2][3];
+    float c1 = matrix[2][0]*matrix[3][2] - matrix[3][0]*matrix[2][2];
+    float c0 = matrix[2][0]*matrix[3][1] - matrix[3][0]*matrix[2][1];
+
+    float det = s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+    if(floatIsEqual(det, 0.0f)){
+        throw std::invalid_argument("inverse: Matrix is not invertable\n" + toString());
+    }
+    float invDet = 1/det;
+
+    Matrix4 m;
+    m.matrix[0][0] = ( matrix[1][1]*c5 - matrix[1][2]*c4 + matrix[1][3]*c3)*invDet;
+    m.matrix[0][1] = (-matrix[0][1]*c5 + matrix[0][2]*c4 - matrix[0][3]*c3)*invDet;
+    m.matrix[0][2] = ( matrix[3][1]*s5 - matrix[3][2]*s4 + matrix[3][3]*s3)*invDet;
+    m.matrix[0][3] = (-matrix[2][1]*s5 + matrix[2][2]*s4 - matrix[2][3]*s3)*invDet;
+
+    m.matrix[1][0] = (-matrix[1][0]*c5 + matrix[1][2]*c2 - matrix[1][3]*c1)*invDet;
+    m.matrix[1][1] = ( matrix[0][0]*c5 - matrix[0][2]*c2 + matrix[0][3]*c1)*invDet;
+    m.matrix[1][2] = (-matrix[3][0]*s5 + matrix[3][2]*s2 - matrix[3][3]*s1)*invDet;
+    m.matrix[1][3] = ( matrix[2][0]*s5 - matrix[2][2]*s2 + matrix[2][3]*s1)*invDet;
+
+    m.matrix[2][0] = ( matrix[1][0]*c4 - matrix[1][1]*c2 + matrix[1][3]*c0)*invDet;
+    m.matrix[2][1] = (-matrix[0][0]*c4 + matrix[0][1]*c2 - matrix[0][3]*c0)*invDet;
+    m.matrix[2][2] = ( matrix[3][0]*s4 - matrix[3][1]*s2 + matrix[3][3]*s0)*invDet;
+    m.matrix[2][3] = (-matrix[2][0]*s4 + matrix[2][1]*s2 - matrix[2][3]*s0)*invDet;
+
+    m.matrix[3][0] = (-matrix[1][0]*c3 + matrix[1][1]*c1 - matrix[1][2]*c0)*invDet;
+    m.matrix[3][1] = ( matrix[0][0]*c3 - matrix[0][1]*c1 + matrix[0][2]*c0)*invDet;
+    m.matrix[3][2] = (-matrix[3][0]*s3 + matrix[3][1]*s1 - matrix[3][2]*s0)*invDet;
+    m.matrix[3][3] = ( matrix[2][0]*s3 - matrix[2][1]*s1 + matrix[2][2]*s0)*invDet;
+
+    return m;
+}
+
+// Computes inverse of an affine matrix [A t; 0 1] as [inverse(A) -inverse(A)*t; 0 1]
+// where A is the top left 3x3 matrix and t is the translation column. Only the 3x3
+// inverse has to be computed and it is the 3x3 adjugate divided by the determinant of A
+// (which is also the determinant of the whole matrix)
+Matrix4 Matrix4::inverseAffine() const{
+    if(!isAffine()){
+        throw std::invalid_argument("inverseAffine: Matrix is not affine\n" + toString());
+    }
+
+    // Cofactors of the first row of A
+    float c00 = matrix[1][1]*matrix[2][2] - matrix[1][2]*matrix[2][1];
+    float c01 = matrix[1][2]*matrix[2][0] - matrix[1][0]*matrix[2][2];
+    float c02 = matrix[1][0]*matrix[2][1] - matrix[1][1]*matrix[2][0];
+
+    float det = matrix[0][0]*c00 + matrix[0][1]*c01 + matrix[0][2]*c02;
+    if(floatIsEqual(det, 0.0f)){
+        throw std::invalid_argument("inverse: Matrix is not invertable\n" + toString());
+    }
+    float invDet = 1/det;
+
+    Matrix4 m;
+    m.matrix[0][0] = c00*invDet;
+    m.matrix[1][0] = c01*invDet;
+    m.matrix[2][0] = c02*invDet;
+    m.matrix[0][1] = (matrix[0][2]*matrix[2][1] - matrix[0][1]*matrix[2][2])*invDet;
+    m.matrix[1][1] = (matrix[0][0]*matrix[2][2] - matrix[0][2]*matrix[2][0])*invDet;
+    m.matrix[2][1] = (matrix[0][1]*matrix[2][0] - matrix[0][0]*matrix[2][1])*invDet;
+    m.matrix[0][2] = (matrix[0][1]*matrix[1][2] - matrix[0][2]*matrix[1][1])*invDet;
+    m.matrix[1][2] = (matrix[0][2]*matrix[1][0] - matrix[0][0]*matrix[1][2])*invDet;
+    m.matrix[2][2] = (matrix[0][0]*matrix[1][1] - matrix[0][1]*matrix[1][0])*invDet;
+
+    // Translation of the inverse moves the point back by the original translation in the inverted space
+    for(int r = 0; r < 3; r++){
+        m.matrix[r][3] = -(m.matrix[r][0]*matrix[0][3] + m.matrix[r][1]*matrix[1][3] + m.matrix[r][2]*matrix[2][3]);
+    }
+
+    return m;
+}
+
 // Computes translation matrix given x, y, and z
 // When this matrix is multiplied with a Point
 // The point will be translated in the x direction
@@ -299,9 +556,9 @@ Matrix Matrix::inverse(){
 // the z direction z units away
 // Additionally, multiplying a Vector by this matrix will
 // do nothing because of the point variable being 0.0
-Matrix translationMatrix(float x, float y, float z){
+Matrix4 translationMatrix(float x, float y, float z){
     // Generates 4x4 identity matrix
-    Matrix m(4);
+    Matrix4 m;
 
     // Translation matrix is equivalent to:
     // 1 0 0 x
@@ -318,9 +575,9 @@ Matrix translationMatrix(float x, float y, float z){
 // Does same thing as translation matrix but the multiplied tuple
 // is scaled instead. Works for both points and vectors
 // Can also perform reflection using negative input parameters
-Matrix scalingMatrix(float x, float y, float z){
+Matrix4 scalingMatrix(float x, float y, float z){
     // Generates 4x4 identity matrix
-    Matrix m(4);
+    Matrix4 m;
 
     // Scaling matrix is equivalent to:
     // x 0 0 0
@@ -338,9 +595,9 @@ Matrix scalingMatrix(float x, float y, float z){
 // Does same thing as translation matrix but the multiplied tuple
 // is rotated along specified axis in funct name instead. Works 
 // for points and vectors
-Matrix xRotationMatrix(float r){
+Matrix4 xRotationMatrix(float r){
     // Generates 4x4 identity matrix
-    Matrix m(4);
+    Matrix4 m;
 
     // Scaling matrix is equivalent to:
     // 1  0      0      0
@@ -355,9 +612,9 @@ Matrix xRotationMatrix(float r){
     return m;
 }
 
-Matrix yRotationMatrix(float r){
+Matrix4 yRotationMatrix(float r){
     // Generates 4x4 identity matrix
-    Matrix m(4);
+    Matrix4 m;
 
     // Scaling matrix is equivalent to:
     // cos(r)  0 sin(r) 0
@@ -372,9 +629,9 @@ Matrix yRotationMatrix(float r){
     return m;
 }
 
-Matrix zRotationMatrix(float r){
+Matrix4 zRotationMatrix(float r){
     // Generates 4x4 identity matrix
-    Matrix m(4);
+    Matrix4 m;
 
     // Scaling matrix is equivalent to:
     // cos(r) -sin(r) 0 0
@@ -393,9 +650,9 @@ Matrix zRotationMatrix(float r){
 // the more the x value changes. This can be applied to x and z too(x_z) and other axis combinations
 // as seen in the parameters. This has the effect of making a straight line slanted, etc. Meant to be 
 // used for points, although vectors would work
-Matrix shearingMatrix(float x_y, float x_z, float y_x, float y_z, float z_x, float z_y){
+Matrix4 shearingMatrix(float x_y, float x_z, float y_x, float y_z, float z_x, float z_y){
     // Generates 4x4 identity matrix
-    Matrix m(4);
+    Matrix4 m;
 
     // Scaling matrix is equivalent to:
     // 1   x_y x_z 0
@@ -415,8 +672,8 @@ Matrix shearingMatrix(float x_y, float x_z, float y_x, float y_z, float z_x, flo
 // Chaining transformations, input the matrix transformations as parameters to produce
 // a matrix that performs all transformations at once when multiplied
 // eg. Resulting matrix is equal to C*(B*(A*I)) if input is {A, B, C}
-Matrix chainTransformationMatrices(std::initializer_list<Matrix> matrices){
-    Matrix result = Matrix(4);
+Matrix4 chainTransformationMatrices(std::initializer_list<Matrix4> matrices){
+    Matrix4 result;
     for (auto m : matrices) {
         result = m*result;
     }
@@ -443,11 +700,11 @@ Matrix chainTransformationMatrices(std::initializer_list<Matrix> matrices){
 // Afterwards, multiply this matrix by the translationMatrix(-cameraPosition). This is because since you are actually
 // moving the world relative to the camera, you need to orient the scene and then move it to the appropriate position
 // relative to the camera
-Matrix viewTransformationMatrix(Point cameraPosition, Point to, Vector up){
+Matrix4 viewTransformationMatrix(const Point &cameraPosition, const Point &to, const Vector &up){
     Vector forward = Vector((to - cameraPosition)).normalize();
     Vector left = crossProduct(forward, up.normalize());
     Vector trueUp = crossProduct(left, forward);
-    Matrix orientation(4);
+    Matrix4 orientation;
 
     orientation.setElement(0, 0, left.x);
     orientation.setElement(0, 1, left.y);
@@ -0,0 +1,465 @@
+#include "ObjParser.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Face corner written as a negative index. The chunk doesn't know how many vertices come before it, so
+// the corner is stored relative to the chunk's first vertex and resolved once the chunks are merged
+struct RelativeIndex{
+    // Position of the corner in the chunk's indices
+    size_t position;
+    // Negative when the corner refers to a vertex in an earlier chunk
+    int64_t vertex;
+};
+
+// "g" line, the faces from position on in the chunk's indices belong to the group
+struct GroupSwitch{
+    size_t position;
+    std::string name;
+};
+
+// Indices [begin, end) of a chunk that belong to group, and where they go in the group's indices
+struct IndexRun{
+    int group;
+    size_t begin;
+    size_t end;
+    size_t destination;
+};
+
+// Lines [begin, end) of the text and what was parsed from them
+struct ObjChunk{
+    const char* begin;
+    const char* end;
+    std::vector<Point> vertices;
+    std::vector<Vector> normals;
+    std::vector<uint32_t> indices;
+    std::vector<RelativeIndex> relative;
+    std::vector<GroupSwitch> switches;
+    int ignoredLines = 0;
+
+    // Set when the chunks are merged
+    size_t vertexOffset = 0;
+    size_t normalOffset = 0;
+    std::vector<IndexRun> runs;
+};
+
+// Read only mapping of a whole file, the parser reads the file straight from the page cache instead of
+// copying it into a buffer first
+class MappedFile{
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+public:
+    MappedFile(const std::string &path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* getData() const;
+    size_t getSize() const;
+};
+
+// Maps the file and closes it again, the mapping stays valid until it is unmapped. An empty file can't
+// be mapped so it is left as a null view of size 0
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &path){
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file == INVALID_HANDLE_VALUE){
+        throw std::invalid_argument("parseObjFile - Cannot open " + path);
+    }
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize)){
+        CloseHandle(file);
+        throw std::invalid_argument("parseObjFile - Cannot read the size of " + path);
+    }
+    size = fileSize.QuadPart;
+
+    if(size > 0){
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(mapping != nullptr){
+            data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            CloseHandle(mapping);
+        }
+        if(data == nullptr){
+            CloseHandle(file);
+            throw std::invalid_argument("parseObjFile - Cannot map " + path);
+        }
+    }
+    CloseHandle(file);
+}
+
+MappedFile::~MappedFile(){
+    if(data != nullptr){
+        UnmapViewOfFile(data);
+    }
+}
+#else
+MappedFile::MappedFile(const std::string &path){
+    int file = open(path.c_str(), O_RDONLY);
+    if(file < 0){
+        throw std::invalid_argument("parseObjFile - Cannot open " + path);
+    }
+    struct stat info;
+    if(fstat(file, &info) != 0){
+        close(file);
+        throw std::invalid_argument("parseObjFile - Cannot read the size of " + path);
+    }
+    size = info.st_size;
+
+    if(size > 0){
+        void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        if(view == MAP_FAILED){
+            close(file);
+            throw std::invalid_argument("parseObjFile - Cannot map " + path);
+        }
+        data = static_cast<const char*>(view);
+    }
+    close(file);
+}
+
+MappedFile::~MappedFile(){
+    if(data != nullptr){
+        munmap(const_cast<char*>(data), size);
+    }
+}
+#endif
+
+const char* MappedFile::getData() const{
+    return data;
+}
+
+size_t MappedFile::getSize() const{
+    return size;
+}
+
+static bool isSpace(char c){
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char* skipSpaces(const char* p, const char* end){
+    while(p < end && isSpace(*p)){
+        p++;
+    }
+    return p;
+}
+
+// Text of a line for error messages
+static std::string lineText(const char* begin, const char* end){
+    begin = skipSpaces(begin, end);
+    while(end > begin && isSpace(*(end - 1))){
+        end--;
+    }
+    return "\"" + std::string(begin, end) + "\"";
+}
+
+// Reads the next number on the line into f and moves p past it
+static bool readFloat(const char* &p, const char* end, float &f){
+    p = skipSpaces(p, end);
+    // from_chars doesn't accept a leading +
+    if(p < end && *p == '+'){
+        p++;
+    }
+    std::from_chars_result result = std::from_chars(p, end, f);
+    if(result.ec != std::errc()){
+        return false;
+    }
+    p = result.ptr;
+    return true;
+}
+
+// Reads three numbers from the rest of a "v" or "vn" line, anything after them(eg. a w coordinate) is ignored
+static void readTriple(const char* p, const char* end, const char* line, float &x, float &y, float &z){
+    if(!readFloat(p, end, x) || !readFloat(p, end, y) || !readFloat(p, end, z)){
+        throw std::invalid_argument("ObjParser - Invalid line " + lineText(line, end));
+    }
+}
+
+// Appends a face corner, positive indices start at 1 and negative indices count back from the last vertex
+static void addCorner(ObjChunk &chunk, int64_t index){
+    if(index > 0){
+        chunk.indices.push_back(index - 1);
+    }else{
+        chunk.relative.push_back({chunk.indices.size(), (int64_t)chunk.vertices.size() + index});
+        chunk.indices.push_back(0);
+    }
+}
+
+// Reads the vertex index of every corner of an "f" line, the texture and normal indices after a / are
+// skipped. A polygon is split into a fan of triangles around its first corner
+static void readFace(ObjChunk &chunk, const char* p, const char* end, const char* line, std::vector<int64_t> &corners){
+    corners.clear();
+    while(true){
+        p = skipSpaces(p, end);
+        if(p == end){
+            break;
+        }
+
+        int64_t index;
+        std::from_chars_result result = std::from_chars(p, end, index);
+        if(result.ec != std::errc() || index == 0 || index > UINT32_MAX || (result.ptr < end && !isSpace(*result.ptr) && *result.ptr != '/')){
+            throw std::invalid_argument("ObjParser - Invalid face " + lineText(line, end));
+        }
+        p = result.ptr;
+        while(p < end && !isSpace(*p)){
+            p++;
+        }
+        corners.push_back(index);
+    }
+
+    if(corners.size() < 3){
+        throw std::invalid_argument("ObjParser - Face with fewer than 3 vertices " + lineText(line, end));
+    }
+    for(int i = 1; i + 1 < corners.size(); i++){
+        addCorner(chunk, corners.at(0));
+        addCorner(chunk, corners.at(i));
+        addCorner(chunk, corners.at(i + 1));
+    }
+}
+
+static void parseLine(ObjChunk &chunk, const char* line, const char* end, std::vector<int64_t> &corners){
+    const char* p = skipSpaces(line, end);
+    if(p == end){
+        return;
+    }
+    const char* keyEnd = p;
+    while(keyEnd < end && !isSpace(*keyEnd)){
+        keyEnd++;
+    }
+    size_t length = keyEnd - p;
+
+    float x, y, z;
+    if(length == 1 && p[0] == 'v'){
+        readTriple(keyEnd, end, line, x, y, z);
+        chunk.vertices.push_back(Point(x, y, z));
+    }else if(length == 2 && p[0] == 'v' && p[1] == 'n'){
+        readTriple(keyEnd, end, line, x, y, z);
+        chunk.normals.push_back(Vector(x, y, z));
+    }else if(length == 1 && p[0] == 'f'){
+        readFace(chunk, keyEnd, end, line, corners);
+    }else if(length == 1 && p[0] == 'g'){
+        const char* nameEnd = end;
+        while(nameEnd > keyEnd && isSpace(*(nameEnd - 1))){
+            nameEnd--;
+        }
+        const char* name = skipSpaces(keyEnd, nameEnd);
+        chunk.switches.push_back({chunk.indices.size(), std::string(name, nameEnd)});
+    }else{
+        chunk.ignoredLines++;
+    }
+}
+
+static void parseChunk(ObjChunk &chunk){
+    std::vector<int64_t> corners;
+    const char* p = chunk.begin;
+    while(p < chunk.end){
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', chunk.end - p));
+        if(lineEnd == nullptr){
+            lineEnd = chunk.end;
+        }
+        parseLine(chunk, p, lineEnd, corners);
+        p = lineEnd + 1;
+    }
+}
+
+// Parses the chunks in parallel, then works out where every chunk's vertices and faces go in the final
+// buffers and copies them there in parallel
+ObjParser::ObjParser(const char* data, size_t size, int threads){
+    ThreadPool &pool = sharedThreadPool(threads);
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(size/MIN_CHUNK_SIZE, pool.getThreadCount()*CHUNKS_PER_THREAD));
+
+    // Splits the text into chunks of about the same size, each chunk ends after a newline
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char* start = data;
+    const char* end = data + size;
+    for(size_t i = 0; i < chunkCount; i++){
+        const char* split = i + 1 == chunkCount ? end : std::max(start, data + size*(i + 1)/chunkCount);
+        if(split < end && split > data){
+            const char* newline = static_cast<const char*>(std::memchr(split - 1, '\n', end - split + 1));
+            split = newline == nullptr ? end : newline + 1;
+        }
+        chunks.at(i).begin = start;
+        chunks.at(i).end = split;
+        start = split;
+    }
+
+    pool.parallelFor(chunkCount, [&](int i){
+        parseChunk(chunks.at(i));
+    });
+
+    // Offsets of each chunk's vertices and normals, and the runs of its faces that belong to each group.
+    // A chunk starts in the group the previous chunk ended in
+    std::unordered_map<std::string, int> groupIDs({{"", 0}});
+    std::vector<size_t> groupSizes(1, 0);
+    groups.push_back({"", {}});
+    size_t vertexCount = 0;
+    size_t normalCount = 0;
+    int group = 0;
+    for(size_t i = 0; i < chunkCount; i++){
+        ObjChunk &chunk = chunks.at(i);
+        chunk.vertexOffset = vertexCount;
+        chunk.normalOffset = normalCount;
+        vertexCount += chunk.vertices.size();
+        normalCount += chunk.normals.size();
+        ignoredLines += chunk.ignoredLines;
+
+        size_t position = 0;
+        for(size_t s = 0; s <= chunk.switches.size(); s++){
+            size_t runEnd = s < chunk.switches.size() ? chunk.switches.at(s).position : chunk.indices.size();
+            if(runEnd > position){
+                chunk.runs.push_back({group, position, runEnd, groupSizes.at(group)});
+                groupSizes.at(group) += runEnd - position;
+            }
+            position = runEnd;
+
+            if(s < chunk.switches.size()){
+                const std::string &name = chunk.switches.at(s).name;
+                auto found = groupIDs.find(name);
+                if(found == groupIDs.end()){
+                    group = groups.size();
+                    groupIDs[name] = group;
+                    groups.push_back({name, {}});
+                    groupSizes.push_back(0);
+                }else{
+                    group = found->second;
+                }
+            }
+        }
+    }
+    if(vertexCount > UINT32_MAX){
+        throw std::invalid_argument("ObjParser - Too many vertices for 32 bit indices: " + std::to_string(vertexCount));
+    }
+
+    vertices.resize(vertexCount);
+    normals.resize(normalCount);
+    for(int g = 0; g < groups.size(); g++){
+        groups.at(g).indices.resize(groupSizes.at(g));
+    }
+
+    pool.parallelFor(chunkCount, [&](int i){
+        ObjChunk &chunk = chunks.at(i);
+        for(int r = 0; r < chunk.relative.size(); r++){
+            int64_t vertex = (int64_t)chunk.vertexOffset + chunk.relative.at(r).vertex;
+            if(vertex < 0){
+                throw std::invalid_argument("ObjParser - Relative index before the first vertex");
+            }
+            chunk.indices.at(chunk.relative.at(r).position) = vertex;
+        }
+        for(int c = 0; c < chunk.indices.size(); c++){
+            if(chunk.indices[c] >= vertexCount){
+                throw std::invalid_argument("ObjParser - Face refers to vertex " + std::to_string(chunk.indices[c] + 1) +
+                    " of " + std::to_string(vertexCount));
+            }
+        }
+
+        std::copy(chunk.vertices.begin(), chunk.vertices.end(), vertices.begin() + chunk.vertexOffset);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalOffset);
+        for(int r = 0; r < chunk.runs.size(); r++){
+            const IndexRun &run = chunk.runs.at(r);
+            std::copy(chunk.indices.begin() + run.begin, chunk.indices.begin() + run.end,
+                groups.at(run.group).indices.begin() + run.destination);
+        }
+
+        // Frees the chunk's buffers now instead of once every chunk is done
+        chunk = ObjChunk();
+    });
+}
+
+ObjParser::ObjParser(const std::string &text, int threads) : ObjParser(text.data(), text.size(), threads){}
+
+// Getters
+const std::vector<Point>& ObjParser::getVertices() const{
+    return vertices;
+}
+
+const std::vector<Vector>& ObjParser::getNormals() const{
+    return normals;
+}
+
+const std::vector<ObjGroup>& ObjParser::getGroups() const{
+    return groups;
+}
+
+int ObjParser::getIgnoredLines() const{
+    return ignoredLines;
+}
+
+ObjModel::ObjModel(){
+    shapes.push_back(std::unique_ptr<Shape>(new Group));
+}
+
+void ObjModel::append(Group* parent, Shape* s){
+    shapes.push_back(std::unique_ptr<Shape>(s));
+    parent->appendShape(s);
+}
+
+Group* ObjModel::getRoot() const{
+    return static_cast<Group*>(shapes.front().get());
+}
+
+ObjModel ObjParser::toModel(){
+    int groupsWithFaces = 0;
+    for(int g = 0; g < groups.size(); g++){
+        groupsWithFaces += !groups.at(g).indices.empty();
+    }
+
+    // Maps a vertex to its index in the mesh of the group that last used it, so each group's vertices are
+    // gathered in one pass over its indices
+    std::vector<int> owner(groupsWithFaces > 1 ? vertices.size() : 0, -1);
+    std::vector<uint32_t> remap(owner.size());
+
+    ObjModel model;
+    Group* root = model.getRoot();
+    for(int g = 0; g < groups.size(); g++){
+        Group* parent = root;
+        if(g > 0){
+            parent = new Group;
+            model.append(root, parent);
+        }
+        std::vector<uint32_t> &indices = groups.at(g).indices;
+        if(indices.empty()){
+            continue;
+        }
+
+        if(groupsWithFaces == 1){
+            model.append(parent, new TriangleMesh(std::move(vertices), std::move(indices)));
+            continue;
+        }
+        std::vector<Point> used;
+        for(int i = 0; i < indices.size(); i++){
+            uint32_t v = indices[i];
+            if(owner[v] != g){
+                owner[v] = g;
+                remap[v] = used.size();
+                used.push_back(vertices[v]);
+            }
+            indices[i] = remap[v];
+        }
+        model.append(parent, new TriangleMesh(std::move(used), std::move(indices)));
+    }
+
+    vertices = std::vector<Point>();
+    normals = std::vector<Vector>();
+    groups = std::vector<ObjGroup>();
+    ignoredLines = 0;
+    return model;
+}
+
+// The file stays mapped only while it is parsed, the parser copies everything it keeps
+ObjParser parseObjFile(const std::string &path, int threads){
+    MappedFile file(path);
+    return ObjParser(file.getData(), file.getSize(), threads);
+}
@@ -1,23 +1,28 @@
 #include "Pattern.h"
 #include "Shape.h"
 
-Matrix Pattern::getTransform(){
+const Matrix4& Pattern::getTransform() const{
     return transform;
 }
 
-void Pattern::setTransform(Matrix m){
+void Pattern::setTransform(const Matrix4 &m){
     transform = m;
+    inverseTransform = m.inverse();
 }
 
-Colour Pattern::applyPattern(Shape* s, Point p){
+const Matrix4& Pattern::getInverseTransform() const{
+    return inverseTransform;
+}
+
+Colour Pattern::applyPattern(Shape* s, const Point &p) const{
     // Transform the pattern based on how the object is transformed
-    Point object_point = Point(s->getTransform().inverse()*p);
+    Point object_point = Point(s->getInverseTransform()*p);
     // Transform the point based on how we want the pattern to be transformed
-    Point pattern_point = Point(transform.inverse()*object_point);
+    Point pattern_point = Point(inverseTransform*object_point);
     return ChildApplyPattern(pattern_point);
 }
 
-Colour Pattern::ChildApplyPattern(Point p){
+Colour Pattern::ChildApplyPattern(const Point &p) const{
     return Colour(p.x, p.y, p.z);
 }
 
@@ -33,7 +38,7 @@ Stripes::Stripes(std::initializer_list<Colour> colours){
     }
 }
 
-Colour Stripes::ChildApplyPattern(Point p){
+Colour Stripes::ChildApplyPattern(const Point &p) const{
     return colours.at((int)floor(p.x) % colours.size());
 }
 
@@ -49,7 +54,7 @@ LinearGradient::LinearGradient(std::initializer_list<Colour> colours){
     }
 }
 
-Colour LinearGradient::ChildApplyPattern(Point p){
+Colour LinearGradient::ChildApplyPattern(const Point &p) const{
     Colour colourDistance = colours.at(1) - colours.at(0);
     float pointDistance = p.x - (float)floor(p.x);
 
@@ -68,7 +73,7 @@ RingPattern::RingPattern(std::initializer_list<Colour> colours){
     }
 }
 
-Colour RingPattern::ChildApplyPattern(Point p){
+Colour RingPattern::ChildApplyPattern(const Point &p) const{
     return colours.at((int)floor(sqrt(pow(p.x, 2) + pow(p.z, 2))) % colours.size());
 }
 
@@ -84,6 +89,6 @@ CheckerPattern::CheckerPattern(std::initializer_list<Colour> colours){
     }
 }
 
-Colour CheckerPattern::ChildApplyPattern(Point p){
+Colour CheckerPattern::ChildApplyPattern(const Point &p) const{
     return colours.at((int)floor(floor(p.x) + floor(p.y) + floor(p.z)) % colours.size());
 }
@@ -0,0 +1,206 @@
+#include "PrimitiveStore.h"
+#include <typeinfo>
+
+// Per thread buffer reused by closestIntersection and occludes, like the one used by Shape
+static thread_local std::vector<Intersection> scratchIntersections;
+
+// Matches the exact type so a subclass of a built in shape is not mistaken for it
+PrimitiveType PrimitiveStore::typeOf(Shape* s){
+    const std::type_info &type = typeid(*s);
+    if(type == typeid(Sphere)){
+        return PRIMITIVE_SPHERE;
+    }else if(type == typeid(Plane)){
+        return PRIMITIVE_PLANE;
+    }else if(type == typeid(Cube)){
+        return PRIMITIVE_CUBE;
+    }else if(type == typeid(Cylinder)){
+        return PRIMITIVE_CYLINDER;
+    }else if(type == typeid(Cone)){
+        return PRIMITIVE_CONE;
+    }else if(type == typeid(Triangle)){
+        return PRIMITIVE_TRIANGLE;
+    }
+
+    return PRIMITIVE_SHAPE;
+}
+
+// Copies the shape's world inverse and geometry into the hot arrays of its type, and the shape into the
+// cold table
+void PrimitiveStore::add(Shape* s){
+    PrimitiveType type = typeOf(s);
+    PrimitiveRef ref = {type, 0};
+
+    switch(type){
+        case PRIMITIVE_SPHERE:
+            ref.index = sphereInverses.size();
+            sphereInverses.push_back(s->getWorldInverse());
+            break;
+        case PRIMITIVE_PLANE:
+            ref.index = planeInverses.size();
+            planeInverses.push_back(s->getWorldInverse());
+            break;
+        case PRIMITIVE_CUBE:
+            ref.index = cubeInverses.size();
+            cubeInverses.push_back(s->getWorldInverse());
+            break;
+        case PRIMITIVE_CYLINDER:{
+            Cylinder* c = static_cast<Cylinder*>(s);
+            ref.index = cylinderInverses.size();
+            cylinderInverses.push_back(s->getWorldInverse());
+            cylinderBounds.push_back({c->getMinH(), c->getMaxH(), c->getClosed()});
+            break;
+        }
+        case PRIMITIVE_CONE:{
+            Cone* c = static_cast<Cone*>(s);
+            ref.index = coneInverses.size();
+            coneInverses.push_back(s->getWorldInverse());
+            coneBounds.push_back({c->getMinH(), c->getMaxH(), c->getClosed()});
+            break;
+        }
+        case PRIMITIVE_TRIANGLE:{
+            Triangle* t = static_cast<Triangle*>(s);
+            const Matrix4 &m = s->getWorldTransform();
+            ref.index = triangleVertices.size();
+            triangleVertices.push_back({m*t->getP1(), m*t->getP2(), m*t->getP3()});
+            break;
+        }
+        default:
+            ref.index = otherCount++;
+            break;
+    }
+
+    refs.push_back(ref);
+    shapes.push_back(s);
+}
+
+void PrimitiveStore::clear(){
+    refs.clear();
+    sphereInverses.clear();
+    planeInverses.clear();
+    cubeInverses.clear();
+    cylinderInverses.clear();
+    cylinderBounds.clear();
+    coneInverses.clear();
+    coneBounds.clear();
+    triangleVertices.clear();
+    otherCount = 0;
+    shapes.clear();
+}
+
+// Getters
+int PrimitiveStore::size() const{
+    return refs.size();
+}
+
+PrimitiveType PrimitiveStore::getType(int id) const{
+    return refs.at(id).type;
+}
+
+int PrimitiveStore::count(PrimitiveType type) const{
+    switch(type){
+        case PRIMITIVE_SPHERE: return sphereInverses.size();
+        case PRIMITIVE_PLANE: return planeInverses.size();
+        case PRIMITIVE_CUBE: return cubeInverses.size();
+        case PRIMITIVE_CYLINDER: return cylinderInverses.size();
+        case PRIMITIVE_CONE: return coneInverses.size();
+        case PRIMITIVE_TRIANGLE: return triangleVertices.size();
+        default: return otherCount;
+    }
+}
+
+Shape* PrimitiveStore::getShape(int id) const{
+    return shapes.at(id);
+}
+
+MaterialID PrimitiveStore::getMaterialID(int id) const{
+    return shapes.at(id)->getMaterialID();
+}
+
+const Material& PrimitiveStore::getMaterial(int id) const{
+    return shapes.at(id)->getMaterial();
+}
+
+// Moves the ray into the primitive's object space and calls the kernel of its type directly. The shape
+// pointer is passed along only so the kernel can record it in the intersections it appends
+void PrimitiveStore::intersect(int id, const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax) const{
+    int i = refs[id].index;
+    switch(refs[id].type){
+        case PRIMITIVE_SPHERE:
+            Sphere::intersect(r.transform(sphereInverses[i]), shapes[id], intersects, tMin, tMax);
+            break;
+        case PRIMITIVE_PLANE:
+            Plane::intersect(r.transform(planeInverses[i]), shapes[id], intersects, tMin, tMax);
+            break;
+        case PRIMITIVE_CUBE:
+            Cube::intersect(r.transform(cubeInverses[i]), shapes[id], intersects, tMin, tMax);
+            break;
+        case PRIMITIVE_CYLINDER:{
+            const CappedBounds &b = cylinderBounds[i];
+            Cylinder::intersect(r.transform(cylinderInverses[i]), b.minH, b.maxH, b.closed, shapes[id], intersects, tMin, tMax);
+            break;
+        }
+        case PRIMITIVE_CONE:{
+            const CappedBounds &b = coneBounds[i];
+            Cone::intersect(r.transform(coneInverses[i]), b.minH, b.maxH, b.closed, shapes[id], intersects, tMin, tMax);
+            break;
+        }
+        case PRIMITIVE_TRIANGLE:{
+            // An affine transform doesn't change t, so the world ray can be tested against the world vertices
+            const TriangleVertices &v = triangleVertices[i];
+            Triangle::intersect(r, v.p1, v.p2, v.p3, shapes[id], intersects, tMin, tMax);
+            break;
+        }
+        default:
+            shapes[id]->findWorldIntersections(r, intersects);
+            break;
+    }
+}
+
+// Finds the nearest intersection of primitive i in [tMin, tMax). Other shapes are asked directly, so a shape
+// with its own acceleration structure(eg. a triangle mesh) can use it
+bool PrimitiveStore::closestIntersection(int id, const Ray &r, float tMin, float &tMax, Intersection &hit) const{
+    if(refs[id].type == PRIMITIVE_SHAPE){
+        return shapes[id]->closestWorldIntersection(r, tMin, tMax, hit);
+    }
+
+    std::vector<Intersection> &intersects = scratchIntersections;
+    intersects.clear();
+    intersect(id, r, intersects, tMin, tMax);
+    bool found = false;
+
+    for(int a = 0; a < intersects.size(); a++){
+        float t = intersects[a].getTime();
+        if(t >= tMin && t < tMax){
+            tMax = t;
+            hit = intersects[a];
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+// Checks for an intersection in (tMin, tMax) with a shape that casts shadows. Primitives stored by value
+// are skipped using their shape's material before any intersection math, other shapes may contain several
+// shapes(eg. a group) so they are asked directly and check each hit's own material
+bool PrimitiveStore::occludes(int id, const Ray &r, float tMin, float tMax) const{
+    if(refs[id].type == PRIMITIVE_SHAPE){
+        return shapes[id]->worldOccludes(r, tMin, tMax);
+    }
+    if(!shapes[id]->getMaterial().castsShadow){
+        return false;
+    }
+
+    std::vector<Intersection> &intersects = scratchIntersections;
+    intersects.clear();
+    intersect(id, r, intersects, tMin, tMax);
+
+    for(int a = 0; a < intersects.size(); a++){
+        float t = intersects[a].getTime();
+        if(t > tMin && t < tMax){
+            return true;
+        }
+    }
+
+    return false;
+}
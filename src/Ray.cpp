@@ -6,26 +6,26 @@ Ray::Ray(){
     direction = Vector();
 }
 
-Ray::Ray(Point o, Vector d){
+Ray::Ray(const Point &o, const Vector &d){
     origin = o;
     direction = d;
 }
 
 // Returns private variables origin and direction
-Point Ray::getOrigin(){
+const Point& Ray::getOrigin() const{
     return origin;
 }
 
-Vector Ray::getDirection(){
+const Vector& Ray::getDirection() const{
     return direction;
 }
 
 // Computes the position of the ray at time t
-Tuple Ray::computePosition(float t){
+Tuple Ray::computePosition(float t) const{
     return (origin + (direction*t));
 }
 
 // Transforms the ray by the matrix m
-Ray Ray::transform(Matrix m){
+Ray Ray::transform(const Matrix4 &m) const{
     return Ray(Point(m*origin), Vector(m*direction));
 }
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "RenderStats.h"
+#include <atomic>
+#include <mutex>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+// Counters owned by one thread. Only the owning thread writes to them, collectRenderStats reads them
+// from other threads so they are atomics accessed with relaxed loads and stores
+struct ThreadRenderCounters{
+    std::atomic<uint64_t> counters[RENDER_COUNTER_COUNT];
+
+    ThreadRenderCounters();
+    ~ThreadRenderCounters();
+};
+
+// Every live thread's counters, the totals of threads that have exited and the stage times
+struct RenderStatsRegistry{
+    std::mutex lock;
+    std::vector<ThreadRenderCounters*> threads;
+    RenderStats retired;
+};
+
+static RenderStatsRegistry& registry(){
+    static RenderStatsRegistry r;
+    return r;
+}
+
+// Registers the thread's counters so they are included when the stats are collected
+ThreadRenderCounters::ThreadRenderCounters(){
+    for(int i = 0; i < RENDER_COUNTER_COUNT; i++){
+        counters[i].store(0, std::memory_order_relaxed);
+    }
+
+    RenderStatsRegistry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    r.threads.push_back(this);
+}
+
+// Moves the counts of an exiting thread, such as a worker of a destroyed thread pool, into the retired totals
+ThreadRenderCounters::~ThreadRenderCounters(){
+    RenderStatsRegistry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    for(int i = 0; i < RENDER_COUNTER_COUNT; i++){
+        r.retired.counters[i] += counters[i].load(std::memory_order_relaxed);
+    }
+    r.threads.erase(std::remove(r.threads.begin(), r.threads.end(), this), r.threads.end());
+}
+
+static ThreadRenderCounters& threadCounters(){
+    static thread_local ThreadRenderCounters c;
+    return c;
+}
+
+// RenderStats constructor
+RenderStats::RenderStats(){
+    for(int i = 0; i < RENDER_COUNTER_COUNT; i++){
+        counters[i] = 0;
+    }
+    for(int i = 0; i < RENDER_STAGE_COUNT; i++){
+        stageSeconds[i] = 0;
+    }
+}
+
+uint64_t RenderStats::getCounter(RenderCounter c){
+    return counters[c];
+}
+
+double RenderStats::getStageSeconds(RenderStage s){
+    return stageSeconds[s];
+}
+
+// Formats the counters and stage times as one "name value" line each
+std::string RenderStats::report(){
+    std::ostringstream out;
+    out << "Render statistics" << (RENDER_STATS_ENABLED ? "" : " (disabled, compile with -DRENDER_STATS)") << "\n";
+
+    for(int i = 0; i < RENDER_COUNTER_COUNT; i++){
+        out << "  " << std::left << std::setw(26) << renderCounterName(static_cast<RenderCounter>(i)) << counters[i] << "\n";
+    }
+    for(int i = 0; i < RENDER_STAGE_COUNT; i++){
+        out << "  " << std::left << std::setw(26) << renderStageName(static_cast<RenderStage>(i))
+            << std::fixed << std::setprecision(6) << stageSeconds[i] << " s\n";
+    }
+
+    return out.str();
+}
+
+// Uncontended since each thread has its own counters, the load and store compile to plain moves on x86
+void addRenderStat(RenderCounter c, uint64_t n){
+    std::atomic<uint64_t> &counter = threadCounters().counters[c];
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// Stages are timed once per render so the registry lock is not on the render path
+void addStageTime(RenderStage s, double seconds){
+    RenderStatsRegistry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    r.retired.stageSeconds[s] += seconds;
+}
+
+RenderStats collectRenderStats(){
+    RenderStatsRegistry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+
+    RenderStats stats = r.retired;
+    for(int t = 0; t < r.threads.size(); t++){
+        for(int i = 0; i < RENDER_COUNTER_COUNT; i++){
+            stats.counters[i] += r.threads.at(t)->counters[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    return stats;
+}
+
+// Should only be called while nothing is rendering
+void resetRenderStats(){
+    RenderStatsRegistry &r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+
+    r.retired = RenderStats();
+    for(int t = 0; t < r.threads.size(); t++){
+        for(int i = 0; i < RENDER_COUNTER_COUNT; i++){
+            r.threads.at(t)->counters[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::string renderCounterName(RenderCounter c){
+    switch(c){
+        case PRIMARY_RAYS: return "primary rays";
+        case SHADOW_RAYS: return "shadow rays";
+        case REFLECTION_RAYS: return "reflection rays";
+        case REFRACTION_RAYS: return "refraction rays";
+        case SPHERE_TESTS: return "sphere tests";
+        case SPHERE_HITS: return "sphere hits";
+        case PLANE_TESTS: return "plane tests";
+        case PLANE_HITS: return "plane hits";
+        case CUBE_TESTS: return "cube tests";
+        case CUBE_HITS: return "cube hits";
+        case CYLINDER_TESTS: return "cylinder tests";
+        case CYLINDER_HITS: return "cylinder hits";
+        case CONE_TESTS: return "cone tests";
+        case CONE_HITS: return "cone hits";
+        case TRIANGLE_TESTS: return "triangle tests";
+        case TRIANGLE_HITS: return "triangle hits";
+        case GROUP_TESTS: return "group tests";
+        case GROUP_HITS: return "group hits";
+        case MATRIX_INVERSIONS: return "matrix inversions";
+        case PREPARE_LIGHT_DATA_CALLS: return "prepareLightData calls";
+        default: throw std::invalid_argument("renderCounterName: invalid counter");
+    }
+}
+
+std::string renderStageName(RenderStage s){
+    switch(s){
+        case STAGE_BVH_BUILD: return "BVH build";
+        case STAGE_TRACE: return "trace";
+        case STAGE_OUTPUT: return "output";
+        default: throw std::invalid_argument("renderStageName: invalid stage");
+    }
+}
+
+// StageTimer constructor, starts timing the stage
+StageTimer::StageTimer(RenderStage s){
+    stage = s;
+    start = std::chrono::steady_clock::now();
+}
+
+StageTimer::~StageTimer(){
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    addStageTime(stage, elapsed.count());
+}
+
+// IntersectionStat constructor, counts the test and remembers how many intersections there were before it
+IntersectionStat::IntersectionStat(RenderCounter tests, RenderCounter hits, std::vector<Intersection> &intersects) : intersects(intersects){
+    this->hits = hits;
+    start = intersects.size();
+    addRenderStat(tests);
+}
+
+IntersectionStat::~IntersectionStat(){
+    if(intersects.size() > start){
+        addRenderStat(hits);
+    }
+}
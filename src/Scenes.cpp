@@ -0,0 +1,192 @@
+#include "Scenes.h"
+
+// Scene constructor
+Scene::Scene(World w, Camera c) : world(std::move(w)), camera(c){
+    std::set<Pattern*> owned;
+    for(int i = 0; i < world.getObjects().size(); i++){
+        own(world.getObjects().at(i), owned);
+    }
+}
+
+// A pattern shared by several shapes is only owned once
+void Scene::own(Shape* s, std::set<Pattern*> &owned){
+    shapes.push_back(std::unique_ptr<Shape>(s));
+    Pattern* p = s->getMaterial().pattern;
+    if(p != nullptr && owned.insert(p).second){
+        patterns.push_back(std::unique_ptr<Pattern>(p));
+    }
+
+    Group* g = dynamic_cast<Group*>(s);
+    if(g != nullptr){
+        for(int i = 0; i < g->getShapes().size(); i++){
+            own(g->getShapes().at(i), owned);
+        }
+    }
+}
+
+// Builds the scene rendered by main
+Scene mainScene(int hsize, int vsize){
+    LinearGradient* p2 = new LinearGradient({Colour(0.34, 0.89, 0.89), Colour(0.31, 1, 0.44)});
+    p2->setTransform(translationMatrix(1.5, -1, -0.5)*scalingMatrix(2.5, 1, 1));
+    RingPattern* p3 = new RingPattern({Colour(0, 0, 1), Colour(0.5, 0, 1)});
+    p3->setTransform(translationMatrix(-1.5, -0.5, 0.5));
+    Stripes* p4 = new Stripes({Colour(1, 0.65, 0), Colour(1, 1, 0)});
+
+    Cone* middle = new Cone;
+    middle->setClosed(true);
+    middle->setMinH(-3);
+    middle->setTransform(translationMatrix(-0.5, 1, 0.5));
+    Material m;
+    m.colour = Colour(0.1, 1, 0.5);
+    m.diffuse = 0.7;
+    m.specular = 0.3;
+    m.pattern = p2;
+    middle->setMaterial(m);
+
+    Sphere* right = new Sphere;
+    right->setTransform(translationMatrix(1.5, 0.5, -0.5)*scalingMatrix(0.5, 0.5, 0.5));
+    m.colour = Colour(0.5, 1, 0.1);
+    m.pattern = p3;
+    right->setMaterial(m);
+
+    Sphere* left = new Sphere;
+    left->setTransform(translationMatrix(-1.5, 0.33, -0.75)*scalingMatrix(0.33, 0.33, 0.33));
+    m.colour = Colour(1, 0.8, 0.1);
+    m.pattern = p4;
+    left->setMaterial(m);
+
+    World w;
+    w.setLight(LightSource(Point(-10, 10, -10), Colour(1, 1, 1)));
+    w.appendObject(middle);
+    w.appendObject(right);
+    w.appendObject(left);
+
+    Camera c(hsize, vsize, PI/3);
+    c.setTransform(viewTransformationMatrix(Point(0, -6, -10), Point(0, 1, 0), Vector(0, 1, 0)));
+
+    return Scene(w, c);
+}
+
+// Builds defaultWorld viewed from in front of the spheres
+Scene defaultScene(int hsize, int vsize){
+    Camera c(hsize, vsize, PI/2);
+    c.setTransform(viewTransformationMatrix(Point(0, 0, -5), Point(0, 0, 0), Vector(0, 1, 0)));
+
+    return Scene(defaultWorld(), c);
+}
+
+// Builds a glass sphere containing an air bubble above a reflective checkered floor with coloured
+// objects behind it, so most pixels spawn reflection, refraction and shadow rays
+Scene glassScene(int hsize, int vsize){
+    World w;
+    w.setLight(LightSource(Point(-4.9, 4.9, -1), Colour(1, 1, 1)));
+
+    Plane* floor = new Plane;
+    Material m;
+    m.pattern = new CheckerPattern({Colour(0.35, 0.35, 0.35), Colour(0.65, 0.65, 0.65)});
+    m.specular = 0;
+    m.reflective = 0.4;
+    floor->setMaterial(m);
+    w.appendObject(floor);
+
+    Sphere* glass = glassSphere();
+    glass->setTransform(translationMatrix(0, 1.1, 0));
+    m = glass->getMaterial();
+    m.colour = Colour(0.1, 0.1, 0.1);
+    m.ambient = 0;
+    m.diffuse = 0.1;
+    m.specular = 1;
+    m.shininess = 300;
+    m.reflective = 0.9;
+    m.transparency = 0.9;
+    glass->setMaterial(m);
+    w.appendObject(glass);
+
+    // Air bubble inside the glass sphere, nested transparent objects exercise findRefractiveIndices
+    Sphere* bubble = glassSphere();
+    bubble->setTransform(translationMatrix(0, 1.1, 0)*scalingMatrix(0.5, 0.5, 0.5));
+    m = bubble->getMaterial();
+    m.colour = Colour(0.1, 0.1, 0.1);
+    m.ambient = 0;
+    m.diffuse = 0.1;
+    m.reflective = 0.9;
+    m.transparency = 0.9;
+    m.refractiveIndex = 1.00029;
+    bubble->setMaterial(m);
+    w.appendObject(bubble);
+
+    Cube* box = new Cube;
+    box->setTransform(translationMatrix(2.5, 0.75, 3)*yRotationMatrix(PI/5)*scalingMatrix(0.75, 0.75, 0.75));
+    m = Material();
+    m.colour = Colour(0.9, 0.2, 0.2);
+    box->setMaterial(m);
+    w.appendObject(box);
+
+    Cylinder* pillar = new Cylinder;
+    pillar->setMinH(0);
+    pillar->setMaxH(2.5);
+    pillar->setClosed(true);
+    pillar->setTransform(translationMatrix(-2.5, 0, 3)*scalingMatrix(0.6, 1, 0.6));
+    m = Material();
+    m.colour = Colour(0.2, 0.4, 0.9);
+    m.reflective = 0.2;
+    pillar->setMaterial(m);
+    w.appendObject(pillar);
+
+    Camera c(hsize, vsize, PI/3);
+    c.setTransform(viewTransformationMatrix(Point(0, 2.5, -5.5), Point(0, 1, 0), Vector(0, 1, 0)));
+
+    return Scene(w, c);
+}
+
+// Builds a square grid of objects on a floor, cycling through spheres, cubes and cylinders. The grid is
+// deterministic so every run renders the same image
+Scene stressScene(int objects, int hsize, int vsize){
+    if(objects < 1){
+        throw std::invalid_argument("stressScene: objects must be positive");
+    }
+
+    World w;
+    w.setLight(LightSource(Point(-20, 30, -20), Colour(1, 1, 1)));
+
+    Plane* floor = new Plane;
+    Material m;
+    m.pattern = new CheckerPattern({WHITE, Colour(0.2, 0.2, 0.2)});
+    floor->setMaterial(m);
+    w.appendObject(floor);
+
+    int side = ceil(sqrt(objects));
+    float spacing = 2.5;
+    float offset = (side - 1)*spacing/2;
+    for(int i = 0; i < objects; i++){
+        float x = (i % side)*spacing - offset;
+        float z = (i / side)*spacing - offset;
+
+        Shape* s;
+        if(i % 3 == 0){
+            s = new Sphere;
+        }else if(i % 3 == 1){
+            s = new Cube;
+        }else{
+            Cylinder* cylinder = new Cylinder;
+            cylinder->setMinH(-1);
+            cylinder->setMaxH(1);
+            cylinder->setClosed(true);
+            s = cylinder;
+        }
+        s->setTransform(translationMatrix(x, 1, z)*yRotationMatrix(i*0.7));
+
+        m = Material();
+        m.colour = Colour(0.2 + 0.6*(i % 5)/4, 0.2 + 0.6*(i % 7)/6, 0.2 + 0.6*(i % 11)/10);
+        m.reflective = i % 4 == 0 ? 0.3 : 0;
+        s->setMaterial(m);
+        w.appendObject(s);
+    }
+
+    // Looks down at the whole grid from above one corner
+    float distance = offset + 6;
+    Camera c(hsize, vsize, PI/3);
+    c.setTransform(viewTransformationMatrix(Point(-distance, distance, -distance), Point(0, 0, 0), Vector(0, 1, 0)));
+
+    return Scene(w, c);
+}
@@ -1,82 +1,308 @@
 #include "Shape.h"
 #include "Group.h"
 
+// Shape constructors, the default material is shared by every shape that doesn't set one
+Shape::Shape(){}
+
+Shape::Shape(const Shape &s) : transform(s.transform), inverseTransform(s.inverseTransform), inverseTranspose(s.inverseTranspose),
+    materialID(s.materialID), ownsMaterial(s.ownsMaterial), parent(s.parent), worldTransform(s.worldTransform),
+    worldInverse(s.worldInverse), worldInverseTranspose(s.worldInverseTranspose), worldCommitted(s.worldCommitted){
+    if(ownsMaterial){
+        materialID = materialRegistry().addForShape(materialRegistry().copy(s.materialID));
+    }else{
+        materialRegistry().retain(materialID);
+    }
+}
+
+Shape& Shape::operator=(const Shape &s){
+    if(this == &s){
+        return *this;
+    }
+
+    transform = s.transform;
+    inverseTransform = s.inverseTransform;
+    inverseTranspose = s.inverseTranspose;
+    parent = s.parent;
+    worldTransform = s.worldTransform;
+    worldInverse = s.worldInverse;
+    worldInverseTranspose = s.worldInverseTranspose;
+    worldCommitted = s.worldCommitted;
+    if(s.ownsMaterial){
+        setMaterial(materialRegistry().copy(s.materialID));
+    }else{
+        useMaterial(s.materialID);
+    }
+    return *this;
+}
+
+// Drops the shape's reference to its material, which frees the material if the shape owned it
+Shape::~Shape(){
+    materialRegistry().releaseForShape(materialID);
+}
+
 // Getter and setter for transform and material
-Matrix Shape::getTransform(){
+const Matrix4& Shape::getTransform() const{
     return transform;
 }
 
-void Shape::setTransform(Matrix m){
+void Shape::setTransform(const Matrix4 &m){
     transform = m;
+    inverseTransform = m.inverse();
+    inverseTranspose = inverseTransform.transpose();
+
+    // The world matrices of every shape below a group depend on the group's transform, and the world
+    // matrices of a shape inside a group also depend on the groups, so they wait for the next commit
+    invalidateWorldTransforms();
+    if(parent == nullptr){
+        worldTransform = transform;
+        worldInverse = inverseTransform;
+        worldInverseTranspose = inverseTranspose;
+        worldCommitted = true;
+    }
 }
 
-Material Shape::getMaterial(){
-    return material;
+// Getters for the cached inverse and inverse transpose of transform
+const Matrix4& Shape::getInverseTransform() const{
+    return inverseTransform;
 }
 
-void Shape::setMaterial(Material m){
-    material = m;
+const Matrix4& Shape::getInverseTranspose() const{
+    return inverseTranspose;
 }
 
-Group* Shape::getParent(){
+const Material& Shape::getMaterial() const{
+    return materialRegistry().get(materialID);
+}
+
+// The first call registers a material for the shape, later calls overwrite it
+void Shape::setMaterial(const Material &m){
+    if(ownsMaterial){
+        materialRegistry().set(materialID, m);
+    }else{
+        MaterialID id = materialRegistry().addForShape(m);
+        materialRegistry().releaseForShape(materialID);
+        materialID = id;
+        ownsMaterial = true;
+    }
+}
+
+MaterialID Shape::getMaterialID() const{
+    return materialID;
+}
+
+// Releases the shape's own material if it had one, the registered material is not copied
+void Shape::setMaterialID(MaterialID id){
+    if(!materialRegistry().contains(id)){
+        throw std::invalid_argument("Shape::setMaterialID - Invalid material ID: " + std::to_string(id));
+    }
+    if(id == materialID){
+        return;
+    }
+
+    useMaterial(id);
+}
+
+// Takes a reference to the new material before dropping the old one, so switching to the same material
+// never frees it
+void Shape::useMaterial(MaterialID id){
+    materialRegistry().retain(id);
+    materialRegistry().releaseForShape(materialID);
+    materialID = id;
+    ownsMaterial = false;
+}
+
+Group* Shape::getParent() const{
     return parent;
 }
 
 void Shape::setParent(Group* p){
     parent = p;
+    invalidateWorldTransforms();
 }
 
-// Returns a vector of intersections where the ray intersects the surface of the shape
+// Getters for the committed world matrices
+const Matrix4& Shape::getWorldTransform() const{
+    return worldTransform;
+}
+
+const Matrix4& Shape::getWorldInverse() const{
+    return worldInverse;
+}
+
+bool Shape::isWorldCommitted() const{
+    return worldCommitted;
+}
+
+void Shape::invalidateWorldTransforms(){
+    worldCommitted = false;
+}
+
+// The world transform is the parent's world transform followed by the shape's own transform, so its
+// inverse applies the shape's inverse after the parent's
+void Shape::commitTransforms(const Matrix4 &parentTransform, const Matrix4 &parentInverse, std::vector<Shape*> &primitives){
+    worldTransform = parentTransform*transform;
+    worldInverse = inverseTransform*parentInverse;
+    worldInverseTranspose = worldInverse.transpose();
+    worldCommitted = true;
+    primitives.push_back(this);
+}
+
+// Per thread buffer reused by closestIntersection and occludes so the closest hit and shadow
+// queries don't allocate a vector per shape
+static thread_local std::vector<Intersection> scratchIntersections;
+
+// Appends the intersections where the ray intersects the surface of the shape
 // findIntersections does some preprocessing that would be done for any shape
-std::vector<Intersection> Shape::findIntersections(Ray r){
+void Shape::findIntersections(const Ray &r, std::vector<Intersection> &intersects){
     // Any transform that we want to apply to the shape has to be applied inversely to the ray
     // if we want the same result as transforming the shape
-    Ray ray2 = r.transform(transform.inverse());
+    Ray ray2 = r.transform(inverseTransform);
 
-    return childIntersections(ray2);
+    childIntersections(ray2, intersects);
+}
+
+// Returns a vector of intersections where the ray intersects the surface of the shape
+std::vector<Intersection> Shape::findIntersections(const Ray &r){
+    std::vector<Intersection> intersects;
+    findIntersections(r, intersects);
+    return intersects;
+}
+
+// Appends the intersections of a ray in world space, the ray is moved to object space in one step
+void Shape::findWorldIntersections(const Ray &r, std::vector<Intersection> &intersects){
+    childIntersections(r.transform(worldInverse), intersects);
+}
+
+// Finds the nearest intersection in [tMin, tMax), intersections at or beyond tMax are rejected
+bool Shape::closestIntersection(const Ray &r, float tMin, float &tMax, Intersection &hit){
+    return closestObjectIntersection(r.transform(inverseTransform), tMin, tMax, hit);
+}
+
+bool Shape::closestWorldIntersection(const Ray &r, float tMin, float &tMax, Intersection &hit){
+    return closestObjectIntersection(r.transform(worldInverse), tMin, tMax, hit);
+}
+
+bool Shape::closestObjectIntersection(const Ray &objectRay, float tMin, float &tMax, Intersection &hit){
+    std::vector<Intersection> &intersects = scratchIntersections;
+    intersects.clear();
+    childIntersections(objectRay, intersects, tMin, tMax);
+    bool found = false;
+
+    for(int i = 0; i < intersects.size(); i++){
+        float t = intersects.at(i).getTime();
+        if(t >= tMin && t < tMax){
+            tMax = t;
+            hit = intersects.at(i);
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+// Returns at the first intersection in (tMin, tMax) with a shape that casts shadows. The shape of each
+// intersection is checked rather than this shape, so shapes inside a group are handled individually
+bool Shape::occludes(const Ray &r, float tMin, float tMax){
+    return objectOccludes(r.transform(inverseTransform), tMin, tMax);
+}
+
+bool Shape::worldOccludes(const Ray &r, float tMin, float tMax){
+    return objectOccludes(r.transform(worldInverse), tMin, tMax);
+}
+
+bool Shape::objectOccludes(const Ray &objectRay, float tMin, float tMax){
+    std::vector<Intersection> &intersects = scratchIntersections;
+    intersects.clear();
+    childIntersections(objectRay, intersects, tMin, tMax);
+
+    for(int i = 0; i < intersects.size(); i++){
+        float t = intersects.at(i).getTime();
+        if(t > tMin && t < tMax && intersects.at(i).getShape()->getMaterial().castsShadow){
+            return true;
+        }
+    }
+
+    return false;
 }
 
 // childIntersections executes custom code depending on what child class is being executed
-std::vector<Intersection> Shape::childIntersections(Ray r){
-    return std::vector<Intersection>{};
+void Shape::childIntersections(const Ray &r, std::vector<Intersection> &intersects){}
+
+// Shapes without a range aware kernel append all of their intersections
+void Shape::childIntersections(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax){
+    childIntersections(r, intersects);
+}
+
+// Returns the child intersections in a new vector
+std::vector<Intersection> Shape::childIntersections(const Ray &r){
+    std::vector<Intersection> intersects;
+    childIntersections(r, intersects);
+    return intersects;
 }
 
 // Computes the normal vector of a point on the surface of the shape
-// findIntersections does some preprocessing that would be done for any shape
-Vector Shape::computeNormal(Point p){
+// A committed shape converts the point and normal with one matrix each instead of one per parent group
+Vector Shape::computeNormal(const Point &p){
+    return computeNormal(p, Intersection(INFINITY, this));
+}
+
+Vector Shape::computeNormal(const Point &p, const Intersection &hit){
+    if(worldCommitted){
+        Vector objectNormal = childHitNormal(worldInverse*p, hit);
+        return Vector(worldInverseTranspose*objectNormal).normalize();
+    }
+
     Point objectPoint = worldToObject(p);
-    Vector objectNormal = childNormal(objectPoint);
+    Vector objectNormal = childHitNormal(objectPoint, hit);
     return normalToWorld(objectNormal);
 }
 
 // childIntersections executes custom code depending on what child class is being executed
-Vector Shape::childNormal(Point p){
+Vector Shape::childNormal(const Point &p){
     return Vector();
 }
 
+Vector Shape::childHitNormal(const Point &p, const Intersection &hit){
+    return childNormal(p);
+}
+
+// Returns the bounding box of the shape after its transform is applied
+BoundingBox Shape::getBounds(){
+    return childBounds().transform(transform);
+}
+
+// Returns the bounding box of the shape after its world transform is applied
+BoundingBox Shape::getWorldBounds(){
+    return childBounds().transform(worldTransform);
+}
+
+// The geometry of a generic shape is unknown, so it is treated as unbounded
+BoundingBox Shape::childBounds(){
+    return infiniteBoundingBox();
+}
+
 // Shape equality function
 bool Shape::isEqual(Shape* s){
-    return transform.isEqual(s->getTransform()) && material.isEqual(s->getMaterial());
+    return transform.isEqual(s->getTransform()) && getMaterial().isEqual(s->getMaterial());
 }
 
 // Converts a point in the world to a point relative to the shape
 // eg. Converts the point to where it would be if the shape was at the origin
-Point Shape::worldToObject(Point p){
+Point Shape::worldToObject(const Point &p){
     if(parent != nullptr){
-        p = parent->worldToObject(p);
+        return inverseTransform*parent->worldToObject(p);
     }
 
-    return transform.inverse()*p;
+    return inverseTransform*p;
 }
 
-Vector Shape::normalToWorld(Vector normal){
-    normal = Vector(transform.inverse().transpose()*normal);
-    normal = normal.normalize();
+Vector Shape::normalToWorld(const Vector &normal){
+    Vector worldNormal = Vector(inverseTranspose*normal).normalize();
 
     if(parent != nullptr){
-        normal = parent->normalToWorld(normal);
+        worldNormal = parent->normalToWorld(worldNormal);
     }
-    return normal;
+    return worldNormal;
 }
 
 // Sphere constructors
@@ -86,11 +312,11 @@ Sphere::Sphere(){
 }
 
 // Getters for sphere variables
-float Sphere::getRadius(){
+float Sphere::getRadius() const{
     return radius;
 }
 
-Point Sphere::getOrigin(){
+const Point& Sphere::getOrigin() const{
     return origin;
 }
 
@@ -109,9 +335,10 @@ bool Sphere::isEqual(Shape* s){
 // where time = 2 is when the ray first hits the sphere at (-1, 0 , 0) and
 // exits the sphere at time = 4 at point (1, 0, 0)
 // Search about "Line-sphere intersection" for more info on how the math works
-std::vector<Intersection> Sphere::childIntersections(Ray r){
+void Sphere::intersect(const Ray &r, Shape* s, std::vector<Intersection> &intersects, float tMin, float tMax){
+    RENDER_INTERSECTION_STAT(SPHERE_TESTS, SPHERE_HITS, intersects);
     // Vector from spheres center to the ray origin
-    Vector sphere_to_ray = Vector(r.getOrigin() - origin);
+    Vector sphere_to_ray = Vector(r.getOrigin() - Point());
     float a = dotProduct(r.getDirection(), r.getDirection());
     float b = 2*dotProduct(r.getDirection(), sphere_to_ray);
     float c = dotProduct(sphere_to_ray, sphere_to_ray) - 1;
@@ -120,27 +347,50 @@ std::vector<Intersection> Sphere::childIntersections(Ray r){
 
     // If discriminant negative, no intersection
     if(discriminant < 0){
-        return std::vector<Intersection>{};
+        return;
     }
 
     // Otherwise, the result is the two results of the quadratic formula
     // If the ray is tangent to the spheres surface and only intersects the
     // sphere at one point, t1 will be equal to t2
     float t1 = (-b - sqrt(discriminant))/(2*a);
+    // Both intersections are beyond the range
+    if(t1 >= tMax){
+        return;
+    }
     float t2 = (-b + sqrt(discriminant))/(2*a);
 
-    return std::vector<Intersection>{Intersection(t1, this), Intersection(t2, this)};
+    if(t1 >= tMin){
+        intersects.push_back(Intersection(t1, s));
+    }
+    if(t2 >= tMin && t2 < tMax){
+        intersects.push_back(Intersection(t2, s));
+    }
+}
+
+// Computes all intersections of the ray r with the sphere
+void Sphere::childIntersections(const Ray &r, std::vector<Intersection> &intersects){
+    intersect(r, this, intersects);
+}
+
+void Sphere::childIntersections(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax){
+    intersect(r, this, intersects, tMin, tMax);
 }
 
 // Computes the normal vector at the point p on the surface of the sphere
 // The normal vector is the vector that is perpendicular to the surface of the sphere
 // and has a magnitude equal to 1(normalized). Assume point p is always on surface of sphere
-Vector Sphere::childNormal(Point p){
+Vector Sphere::childNormal(const Point &p){
     // Computes the normal vector relative to the sphere
     Vector sphere_normal((p - Point(0, 0, 0)));
     return sphere_normal;
 }
 
+// The default sphere has a radius of 1 and is centered at the origin
+BoundingBox Sphere::childBounds(){
+    return BoundingBox(Point(-1, -1, -1), Point(1, 1, 1));
+}
+
 // Generates a sphere with a glass material
 Sphere* glassSphere(){
     Material m;
@@ -153,48 +403,79 @@ Sphere* glassSphere(){
 }
 
 // Computes the point of intersection of a ray on the plane 
-std::vector<Intersection> Plane::childIntersections(Ray r){
+void Plane::intersect(const Ray &r, Shape* s, std::vector<Intersection> &intersects, float tMin, float tMax){
+    RENDER_INTERSECTION_STAT(PLANE_TESTS, PLANE_HITS, intersects);
     // Since the default plane is an xz plane before transformation, any vector with a y value of ~0(floating-point error) will be parallel to the plane
     // A coplanar ray is a ray that is parallel to the plane and originates on the plane, this ray intersects the plane at every single point
     // This will return zero intersections because if this is the input ray, the camera is viewing the plane edge-on. Since the plane is infinitely thin
     // nothing should be rendered so no need to return any intersections
     if(std::abs(r.getDirection().y) < EPSILON){
-        return std::vector<Intersection>{};
+        return;
     }
 
     // computes the time the ray takes to travel -y units in the y direction(time = distance/speed) so that the ray is on the plane(y value is 0)
     float t = -r.getOrigin().y/r.getDirection().y;
-    return std::vector<Intersection>{Intersection(t, this)};
+    if(t >= tMin && t < tMax){
+        intersects.push_back(Intersection(t, s));
+    }
+}
+
+void Plane::childIntersections(const Ray &r, std::vector<Intersection> &intersects){
+    intersect(r, this, intersects);
+}
+
+void Plane::childIntersections(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax){
+    intersect(r, this, intersects, tMin, tMax);
 }
 
 // The default plane is an xz plane, so the normal vector will be Vector(0, 1, 0)
-Vector Plane::childNormal(Point p){
+Vector Plane::childNormal(const Point &p){
     return Vector(0, 1, 0);
 }
 
+// The plane is infinite in the x and z directions and flat on y = 0
+BoundingBox Plane::childBounds(){
+    return BoundingBox(Point(-INFINITY, 0, -INFINITY), Point(INFINITY, 0, INFINITY));
+}
+
 // Computes all intersections of a ray and the cube
-std::vector<Intersection> Cube::childIntersections(Ray r){
+void Cube::intersect(const Ray &r, Shape* s, std::vector<Intersection> &intersects, float tMin, float tMax){
+    RENDER_INTERSECTION_STAT(CUBE_TESTS, CUBE_HITS, intersects);
     // Computes the times when the ray intersected with the corresponding plane of each face of the cube
-    std::vector<float> xt_minmax = check_axis(r.getOrigin().x, r.getDirection().x);
-    std::vector<float> yt_minmax = check_axis(r.getOrigin().y, r.getDirection().y);
-    std::vector<float> zt_minmax = check_axis(r.getOrigin().z, r.getDirection().z);
+    float xtmin, xtmax, ytmin, ytmax, ztmin, ztmax;
+    check_axis(r.getOrigin().x, r.getDirection().x, xtmin, xtmax);
+    check_axis(r.getOrigin().y, r.getDirection().y, ytmin, ytmax);
+    check_axis(r.getOrigin().z, r.getDirection().z, ztmin, ztmax);
 
     // The largest min time and smallest max time will always be the times the ray intersects with the cube
-    float tmin = std::max({xt_minmax.at(0), yt_minmax.at(0), zt_minmax.at(0)});
-    float tmax = std::min({xt_minmax.at(1), yt_minmax.at(1), zt_minmax.at(1)});
+    float tmin = std::max({xtmin, ytmin, ztmin});
+    float tmax = std::min({xtmax, ytmax, ztmax});
 
-    // Ray does not intersect with cube
-    if(tmin > tmax){
-        return std::vector<Intersection>();
+    // Ray does not intersect with cube, or both intersections are outside the range
+    if(tmin > tmax || tmin >= tMax || tmax < tMin){
+        return;
     }
 
-    return std::vector<Intersection>({Intersection(tmin, this), Intersection(tmax, this)});
+    if(tmin >= tMin){
+        intersects.push_back(Intersection(tmin, s));
+    }
+    if(tmax < tMax){
+        intersects.push_back(Intersection(tmax, s));
+    }
+}
+
+void Cube::childIntersections(const Ray &r, std::vector<Intersection> &intersects){
+    intersect(r, this, intersects);
+}
+
+void Cube::childIntersections(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax){
+    intersect(r, this, intersects, tMin, tMax);
 }
 
 // Computes the normal vector of a point on the cube. For a cube at the origin with a side length of 2,
 // it's normal vector will correspond to the max absolute value of all components on the point.
 // eg. Point(1, 0.5, -0.8) will be on the +x side of the cube and will have a normal of (1, 0, 0)
-Vector Cube::childNormal(Point p){
+Vector Cube::childNormal(const Point &p){
     // maxComponent cannot be set to 1.0 just in case there is floating point error
     float maxComponent = std::max({std::abs(p.x), std::abs(p.y), std::abs(p.z)});
 
@@ -207,16 +488,19 @@ Vector Cube::childNormal(Point p){
     return Vector(0, 0, p.z);
 }
 
+// The default cube has a side length of 2 and is centered at the origin
+BoundingBox Cube::childBounds(){
+    return BoundingBox(Point(-1, -1, -1), Point(1, 1, 1));
+}
+
 // Computes the time that the ray hits the plane corresponding to a negative and positive face of a cube using time = distance/speed 
 // where speed is the direction parameter passed in and distance will be calculated using the origin parameter
 // eg. Calculates when a ray hits a plane at x=-1 and x=1 to determine if the intersection was on the cube's surface
-std::vector<float> check_axis(float origin, float direction){
+void check_axis(float origin, float direction, float &tmin, float &tmax){
     // Distance from origin to the plane x = -1 or x = 1 if origin corresponds to the cube's origin.x
     float tmin_numerator = -1 - origin;
     float tmax_numerator = 1 - origin;
 
-    float tmin, tmax;
-
     if(std::abs(direction) >= EPSILON){
         tmin = tmin_numerator/direction;
         tmax = tmax_numerator/direction;
@@ -228,8 +512,6 @@ std::vector<float> check_axis(float origin, float direction){
     if(tmin > tmax){
         std::swap(tmin, tmax);
     }
-
-    return std::vector<float>({tmin, tmax});
 }
 
 // Cylinder constructor
@@ -273,14 +555,14 @@ void Cylinder::setClosed(bool c){
 }
 
 // Computes all intersections of a ray and the cylinder
-std::vector<Intersection> Cylinder::childIntersections(Ray r){
+void Cylinder::intersect(const Ray &r, float minH, float maxH, bool closed, Shape* s, std::vector<Intersection> &intersects, float tMin, float tMax){
+    RENDER_INTERSECTION_STAT(CYLINDER_TESTS, CYLINDER_HITS, intersects);
     float a = pow(r.getDirection().x, 2) + pow(r.getDirection().z, 2);
 
-    std::vector<Intersection> intersects;
     // If a is approximately 0, ray does not intersect with cylinder walls
     if(std::abs(a) < EPSILON){
-        intersectCaps(r, intersects);
-        return intersects;
+        intersectCaps(r, minH, maxH, closed, s, intersects, tMin, tMax);
+        return;
     }
 
     float b = 2*r.getOrigin().x*r.getDirection().x + 2*r.getOrigin().z*r.getDirection().z;
@@ -294,7 +576,7 @@ std::vector<Intersection> Cylinder::childIntersections(Ray r){
         t1 = -b/(2*a);
     }else if(discriminant < 0){
         // Ray does not intersect if discriminant is negative
-        return std::vector<Intersection>();
+        return;
     }else{
         t0 = (-b - sqrt(discriminant))/(2*a);
         t1 = (-b + sqrt(discriminant))/(2*a);
@@ -305,23 +587,32 @@ std::vector<Intersection> Cylinder::childIntersections(Ray r){
     }
 
     // Computes y values of intersections and checks if they are within cylinder top and bottom bounds
-    float y0 = r.getOrigin().y + t0*r.getDirection().y;
-    if(minH < y0 && y0 < maxH){
-        intersects.push_back(Intersection(t0, this));
-    }
-    float y1 = r.getOrigin().y + t1*r.getDirection().y;
-    if(minH < y1 && y1 < maxH){
-        intersects.push_back(Intersection(t1, this));
+    // The walls are skipped once both intersections are outside the range, the caps may still be in it
+    if(t0 < tMax && t1 >= tMin){
+        float y0 = r.getOrigin().y + t0*r.getDirection().y;
+        if(t0 >= tMin && minH < y0 && y0 < maxH){
+            intersects.push_back(Intersection(t0, s));
+        }
+        float y1 = r.getOrigin().y + t1*r.getDirection().y;
+        if(t1 < tMax && minH < y1 && y1 < maxH){
+            intersects.push_back(Intersection(t1, s));
+        }
     }
 
     // Add intersections with cylinder caps
-    intersectCaps(r, intersects);
+    intersectCaps(r, minH, maxH, closed, s, intersects, tMin, tMax);
+}
 
-    return intersects;
+void Cylinder::childIntersections(const Ray &r, std::vector<Intersection> &intersects){
+    intersect(r, minH, maxH, closed, this, intersects);
+}
+
+void Cylinder::childIntersections(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax){
+    intersect(r, minH, maxH, closed, this, intersects, tMin, tMax);
 }
 
 // Returns normal vector of a point on the cylinder walls or caps(if closed cylinder)
-Vector Cylinder::childNormal(Point p){
+Vector Cylinder::childNormal(const Point &p){
     // Calculates the square of the distance of the point from the y axis, if distance = 1 point is on wall of cylinder
     float distance = pow(p.x, 2) + pow(p.z, 2);
 
@@ -336,8 +627,13 @@ Vector Cylinder::childNormal(Point p){
     return Vector(p.x, 0, p.z);
 }
 
+// The default cylinder has a radius of 1 and spans minH to maxH on the y axis
+BoundingBox Cylinder::childBounds(){
+    return BoundingBox(Point(-1, minH, -1), Point(1, maxH, 1));
+}
+
 // Checks if ray r at time t is inside the radius of the cylinder
-bool Cylinder::insideCapRadius(Ray r, float t){
+bool Cylinder::insideCapRadius(const Ray &r, float t){
     float x = r.getOrigin().x + t*r.getDirection().x;
     float z = r.getOrigin().z + t*r.getDirection().z;
 
@@ -345,7 +641,7 @@ bool Cylinder::insideCapRadius(Ray r, float t){
 }
 
 // Computes ray intersection with cylinder caps
-void Cylinder::intersectCaps(Ray r, std::vector<Intersection> &intersects){
+void Cylinder::intersectCaps(const Ray &r, float minH, float maxH, bool closed, Shape* s, std::vector<Intersection> &intersects, float tMin, float tMax){
     // If cylinder is not closed or ray is travelling parallel to y, intersection never happens
     // Ignores case when ray is on cylinder cap as there will be infinite intersections
     if(!closed || floatIsEqual(r.getDirection().y, 0)){
@@ -354,17 +650,21 @@ void Cylinder::intersectCaps(Ray r, std::vector<Intersection> &intersects){
 
     // Calculates time when ray is level with the bottom cap of the cylinder
     float t = (minH - r.getOrigin().y)/r.getDirection().y;
-    if(insideCapRadius(r, t)){
-        intersects.push_back(Intersection(t, this));
+    if(t >= tMin && t < tMax && insideCapRadius(r, t)){
+        intersects.push_back(Intersection(t, s));
     }
 
     // Calculates time when ray is level with the top cap of the cylinder
     t = (maxH - r.getOrigin().y)/r.getDirection().y;
-    if(insideCapRadius(r, t)){
-        intersects.push_back(Intersection(t, this));
+    if(t >= tMin && t < tMax && insideCapRadius(r, t)){
+        intersects.push_back(Intersection(t, s));
     }
 }
 
+void Cylinder::intersectCaps(const Ray &r, std::vector<Intersection> &intersects){
+    intersectCaps(r, minH, maxH, closed, this, intersects);
+}
+
 // Cone constructor
 Cone::Cone(){
     maxH = INFINITY;
@@ -406,20 +706,23 @@ void Cone::setClosed(bool c){
 }
 
 // Computes all intersections of a ray and the cone
-std::vector<Intersection> Cone::childIntersections(Ray r){
+void Cone::intersect(const Ray &r, float minH, float maxH, bool closed, Shape* s, std::vector<Intersection> &intersects, float tMin, float tMax){
+    RENDER_INTERSECTION_STAT(CONE_TESTS, CONE_HITS, intersects);
     float a = pow(r.getDirection().x, 2) - pow(r.getDirection().y, 2) + pow(r.getDirection().z, 2);
     float b = 2*r.getOrigin().x*r.getDirection().x - 2*r.getOrigin().y*r.getDirection().y + 2*r.getOrigin().z*r.getDirection().z;
     float c = pow(r.getOrigin().x, 2) - pow(r.getOrigin().y, 2) + pow(r.getOrigin().z, 2);
 
-    std::vector<Intersection> intersects;
     // If a is approximately 0, ray does not intersect with cone walls
     if(std::abs(a) < EPSILON){
-        intersectCaps(r, intersects);
+        intersectCaps(r, minH, maxH, closed, s, intersects, tMin, tMax);
         if(std::abs(b) < EPSILON){
-            return intersects;
+            return;
+        }
+        float t = -c/(2*b);
+        if(t >= tMin && t < tMax){
+            intersects.push_back(Intersection(t, s));
         }
-        intersects.push_back(Intersection(-c/(2*b), this));
-        return intersects;
+        return;
     }
 
     float t0;
@@ -430,7 +733,7 @@ std::vector<Intersection> Cone::childIntersections(Ray r){
         t1 = -b/(2*a);
     }else if(discriminant < 0){
         // Ray does not intersect if discriminant is negative
-        return std::vector<Intersection>();
+        return;
     }else{
         t0 = (-b - sqrt(discriminant))/(2*a);
         t1 = (-b + sqrt(discriminant))/(2*a);
@@ -441,23 +744,32 @@ std::vector<Intersection> Cone::childIntersections(Ray r){
     }
 
     // Computes y values of intersections and checks if they are within cylinder top and bottom bounds
-    float y0 = r.getOrigin().y + t0*r.getDirection().y;
-    if(minH < y0 && y0 < maxH){
-        intersects.push_back(Intersection(t0, this));
-    }
-    float y1 = r.getOrigin().y + t1*r.getDirection().y;
-    if(minH < y1 && y1 < maxH){
-        intersects.push_back(Intersection(t1, this));
+    // The walls are skipped once both intersections are outside the range, the caps may still be in it
+    if(t0 < tMax && t1 >= tMin){
+        float y0 = r.getOrigin().y + t0*r.getDirection().y;
+        if(t0 >= tMin && minH < y0 && y0 < maxH){
+            intersects.push_back(Intersection(t0, s));
+        }
+        float y1 = r.getOrigin().y + t1*r.getDirection().y;
+        if(t1 < tMax && minH < y1 && y1 < maxH){
+            intersects.push_back(Intersection(t1, s));
+        }
     }
 
     // Add intersections with cylinder caps
-    intersectCaps(r, intersects);
+    intersectCaps(r, minH, maxH, closed, s, intersects, tMin, tMax);
+}
 
-    return intersects;
+void Cone::childIntersections(const Ray &r, std::vector<Intersection> &intersects){
+    intersect(r, minH, maxH, closed, this, intersects);
+}
+
+void Cone::childIntersections(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax){
+    intersect(r, minH, maxH, closed, this, intersects, tMin, tMax);
 }
 
 // Returns normal vector of a point on the cone walls or caps(if closed cone)
-Vector Cone::childNormal(Point p){
+Vector Cone::childNormal(const Point &p){
     // Calculates the square of the distance of the point from the y axis, if distance = 1 point is on wall of cone
     float distance = pow(p.x, 2) + pow(p.z, 2);
 
@@ -476,8 +788,14 @@ Vector Cone::childNormal(Point p){
     return Vector(p.x, y, p.z);
 }
 
+// The radius of the cone at height y is |y|, so the widest point is at whichever end is farther from the origin
+BoundingBox Cone::childBounds(){
+    float radius = std::max(std::abs(minH), std::abs(maxH));
+    return BoundingBox(Point(-radius, minH, -radius), Point(radius, maxH, radius));
+}
+
 // Checks if ray r at time t is inside the radius of the cone
-bool Cone::insideCapRadius(Ray r, float t, float radius){
+bool Cone::insideCapRadius(const Ray &r, float t, float radius){
     float x = r.getOrigin().x + t*r.getDirection().x;
     float z = r.getOrigin().z + t*r.getDirection().z;
 
@@ -485,7 +803,7 @@ bool Cone::insideCapRadius(Ray r, float t, float radius){
 }
 
 // Computes ray intersection with cone caps
-void Cone::intersectCaps(Ray r, std::vector<Intersection> &intersects){
+void Cone::intersectCaps(const Ray &r, float minH, float maxH, bool closed, Shape* s, std::vector<Intersection> &intersects, float tMin, float tMax){
     // If cone is not closed or ray is travelling parallel to y, intersection never happens
     // Ignores case when ray is on cone cap as there will be infinite intersections
     if(!closed || floatIsEqual(r.getDirection().y, 0)){
@@ -494,13 +812,17 @@ void Cone::intersectCaps(Ray r, std::vector<Intersection> &intersects){
 
     // Calculates time when ray is level with the bottom cap of the cone
     float t = (minH - r.getOrigin().y)/r.getDirection().y;
-    if(insideCapRadius(r, t, minH)){
-        intersects.push_back(Intersection(t, this));
+    if(t >= tMin && t < tMax && insideCapRadius(r, t, minH)){
+        intersects.push_back(Intersection(t, s));
     }
 
     // Calculates time when ray is level with the top cap of the cone
     t = (maxH - r.getOrigin().y)/r.getDirection().y;
-    if(insideCapRadius(r, t, maxH)){
-        intersects.push_back(Intersection(t, this));
+    if(t >= tMin && t < tMax && insideCapRadius(r, t, maxH)){
+        intersects.push_back(Intersection(t, s));
     }
+}
+
+void Cone::intersectCaps(const Ray &r, std::vector<Intersection> &intersects){
+    intersectCaps(r, minH, maxH, closed, this, intersects);
 }
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "ThreadPool.h"
+#include <map>
+
+// Pool whose task the current thread is running, nested calls on that pool run inline instead of waiting
+// for workers that are busy with the outer call
+static thread_local ThreadPool* currentPool = nullptr;
+
+// Number of threads a pool created with the thread count gets
+static int poolThreadCount(int threads){
+    if(threads < 1){
+        threads = std::thread::hardware_concurrency();
+    }
+    // hardware_concurrency can return 0 if it is unknown
+    return threads < 1 ? 1 : threads;
+}
+
+// ThreadPool constructor, starts the workers
+ThreadPool::ThreadPool(int threads){
+    threadCount = poolThreadCount(threads);
+    for(int w = 1; w < threadCount; w++){
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this, w));
+    }
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(int i = 0; i < workers.size(); i++){
+        workers.at(i).join();
+    }
+}
+
+int ThreadPool::getThreadCount(){
+    return threadCount;
+}
+
+// Takes from the front of worker w's queue, otherwise steals from the back of another queue
+int ThreadPool::nextTask(std::vector<WorkQueue> &queues, int w){
+    for(int i = 0; i < queues.size(); i++){
+        WorkQueue &q = queues.at((w + i) % queues.size());
+        std::lock_guard<std::mutex> guard(q.lock);
+        if(q.tasks.empty()){
+            continue;
+        }
+
+        int task;
+        if(i == 0){
+            task = q.tasks.front();
+            q.tasks.pop_front();
+        }else{
+            task = q.tasks.back();
+            q.tasks.pop_back();
+        }
+        return task;
+    }
+
+    return -1;
+}
+
+void ThreadPool::runTasks(Job &j, int w){
+    int t;
+    while(!j.failed && (t = nextTask(j.queues, w)) != -1){
+        try{
+            (*j.task)(t);
+        }catch(...){
+            std::lock_guard<std::mutex> guard(j.errorLock);
+            if(!j.failed){
+                j.error = std::current_exception();
+                j.failed = true;
+            }
+        }
+    }
+}
+
+// Workers without a queue of their own in a job with fewer tasks than threads only report that they are done
+void ThreadPool::workerLoop(int w){
+    currentPool = this;
+    long seen = 0;
+    while(true){
+        Job* current;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [&]{ return stopping || generation != seen; });
+            if(stopping){
+                return;
+            }
+            seen = generation;
+            current = job;
+        }
+
+        if(w < current->queues.size()){
+            runTasks(*current, w);
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        busy--;
+        if(busy == 0){
+            done.notify_one();
+        }
+    }
+}
+
+// Hands the tasks to the workers, the calling thread acts as worker 0 and then waits for the rest
+void ThreadPool::parallelFor(int taskCount, std::function<void(int)> task){
+    if(taskCount <= 0){
+        return;
+    }
+    if(currentPool == this){
+        for(int i = 0; i < taskCount; i++){
+            task(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> call(callLock);
+    Job j;
+    j.task = &task;
+    j.queues = std::vector<WorkQueue>(std::min(threadCount, taskCount));
+    j.failed = false;
+    for(int i = 0; i < taskCount; i++){
+        j.queues.at(i % j.queues.size()).tasks.push_back(i);
+    }
+
+    if(!workers.empty()){
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            job = &j;
+            busy = workers.size();
+            generation++;
+        }
+        wake.notify_all();
+    }
+
+    ThreadPool* previous = currentPool;
+    currentPool = this;
+    runTasks(j, 0);
+    currentPool = previous;
+
+    if(!workers.empty()){
+        std::unique_lock<std::mutex> guard(lock);
+        done.wait(guard, [&]{ return busy == 0; });
+        job = nullptr;
+    }
+
+    if(j.error){
+        std::rethrow_exception(j.error);
+    }
+}
+
+// The pools are never destroyed, like materialRegistry(), so they can be used until the program exits
+ThreadPool& sharedThreadPool(int threads){
+    static std::mutex poolsLock;
+    static std::map<int, ThreadPool*>* pools = new std::map<int, ThreadPool*>;
+
+    int count = poolThreadCount(threads);
+    std::lock_guard<std::mutex> guard(poolsLock);
+    ThreadPool* &pool = (*pools)[count];
+    if(pool == nullptr){
+        pool = new ThreadPool(count);
+    }
+    return *pool;
+}
@@ -0,0 +1,486 @@
+#include "Triangle.h"
+#include <algorithm>
+#include <cmath>
+
+// Component of a tuple on an axis, 0 = x, 1 = y, 2 = z
+static float component(const Tuple &t, int axis){
+    return axis == 0 ? t.x : (axis == 1 ? t.y : t.z);
+}
+
+// Picks the axis the direction is largest on as z, and swaps x and y when the direction is negative on
+// that axis so the winding of the triangles is kept
+WatertightRay::WatertightRay(const Ray &r){
+    origin = r.getOrigin();
+    const Vector &d = r.getDirection();
+    float ax = std::abs(d.x);
+    float ay = std::abs(d.y);
+    float az = std::abs(d.z);
+    kz = ax > ay ? (ax > az ? 0 : 2) : (ay > az ? 1 : 2);
+    kx = (kz + 1) % 3;
+    ky = (kx + 1) % 3;
+    if(component(d, kz) < 0){
+        std::swap(kx, ky);
+    }
+
+    sz = 1.0/component(d, kz);
+    sx = component(d, kx)*sz;
+    sy = component(d, ky)*sz;
+}
+
+// Transforms the vertices into the ray's space, where the ray hits the triangle if the origin is on the
+// same side of all three edges
+bool intersectTriangle(const WatertightRay &r, const Point &a, const Point &b, const Point &c, float &t){
+    Tuple A = a - r.origin;
+    Tuple B = b - r.origin;
+    Tuple C = c - r.origin;
+
+    float az = component(A, r.kz);
+    float bz = component(B, r.kz);
+    float cz = component(C, r.kz);
+    float ax = component(A, r.kx) - r.sx*az;
+    float ay = component(A, r.ky) - r.sy*az;
+    float bx = component(B, r.kx) - r.sx*bz;
+    float by = component(B, r.ky) - r.sy*bz;
+    float cx = component(C, r.kx) - r.sx*cz;
+    float cy = component(C, r.ky) - r.sy*cz;
+
+    // Scaled barycentric coordinates, each is the edge function of the edge opposite a vertex
+    float u = cx*by - cy*bx;
+    float v = ax*cy - ay*cx;
+    float w = bx*ay - by*ax;
+
+    // An edge function of exactly 0 may be rounding error on an edge shared with another triangle,
+    // recomputing it in double precision decides which triangle the ray passes through
+    if(u == 0 || v == 0 || w == 0){
+        u = (double)cx*by - (double)cy*bx;
+        v = (double)ax*cy - (double)ay*cx;
+        w = (double)bx*ay - (double)by*ax;
+    }
+
+    // The origin is outside an edge if the edge functions have different signs
+    if((u < 0 || v < 0 || w < 0) && (u > 0 || v > 0 || w > 0)){
+        return false;
+    }
+
+    // The ray is in the plane of the triangle
+    float det = u + v + w;
+    if(det == 0){
+        return false;
+    }
+
+    t = (u*r.sz*az + v*r.sz*bz + w*r.sz*cz)/det;
+    return true;
+}
+
+// Triangle constructor
+Triangle::Triangle(const Point &p1, const Point &p2, const Point &p3) : p1(p1), p2(p2), p3(p3){
+    e1 = Vector(p2 - p1);
+    e2 = Vector(p3 - p1);
+    normal = crossProduct(e2, e1).normalize();
+}
+
+// Getters
+const Point& Triangle::getP1() const{
+    return p1;
+}
+
+const Point& Triangle::getP2() const{
+    return p2;
+}
+
+const Point& Triangle::getP3() const{
+    return p3;
+}
+
+const Vector& Triangle::getE1() const{
+    return e1;
+}
+
+const Vector& Triangle::getE2() const{
+    return e2;
+}
+
+const Vector& Triangle::getNormal() const{
+    return normal;
+}
+
+void Triangle::intersect(const Ray &r, const Point &p1, const Point &p2, const Point &p3, Shape* s, std::vector<Intersection> &intersects, float tMin, float tMax){
+    RENDER_INTERSECTION_STAT(TRIANGLE_TESTS, TRIANGLE_HITS, intersects);
+    float t;
+    if(intersectTriangle(WatertightRay(r), p1, p2, p3, t) && t >= tMin && t < tMax){
+        intersects.push_back(Intersection(t, s));
+    }
+}
+
+// Computes the intersection of the ray with the triangle
+void Triangle::childIntersections(const Ray &r, std::vector<Intersection> &intersects){
+    intersect(r, p1, p2, p3, this, intersects);
+}
+
+void Triangle::childIntersections(const Ray &r, std::vector<Intersection> &intersects, float tMin, float tMax){
+    intersect(r, p1, p2, p3, this, intersects, tMin, tMax);
+}
+
+Vector Triangle::childNormal(const Point &p){
+    return normal;
+}
+
+// Box around the three vertices
+BoundingBox Triangle::childBounds(){
+    BoundingBox bounds;
+    bounds.addPoint(p1);
+    bounds.addPoint(p2);
+    bounds.addPoint(p3);
+    return bounds;
+}
+
+// Mesh constructor, checks the indices and precomputes the edges and normals before building the BVH
+TriangleMesh::TriangleMesh(std::vector<Point> vertices, std::vector<uint32_t> indices) : vertices(std::move(vertices)), indices(std::move(indices)){
+    if(this->indices.size() % 3 != 0){
+        throw std::invalid_argument("TriangleMesh - Number of indices is not a multiple of 3: " + std::to_string(this->indices.size()));
+    }
+    for(int i = 0; i < this->indices.size(); i++){
+        if(this->indices.at(i) >= this->vertices.size()){
+            throw std::invalid_argument("TriangleMesh - Index out of range: " + std::to_string(this->indices.at(i)));
+        }
+    }
+
+    int count = getTriangleCount();
+    edges.reserve(count);
+    normals.reserve(count);
+    order.reserve(count);
+    std::vector<BoundingBox> boxes(count);
+    for(int i = 0; i < count; i++){
+        Vector e1 = Vector(vertex(i, 1) - vertex(i, 0));
+        Vector e2 = Vector(vertex(i, 2) - vertex(i, 0));
+        edges.push_back({e1, e2});
+        normals.push_back(crossProduct(e2, e1).normalize());
+        order.push_back(i);
+
+        for(int corner = 0; corner < 3; corner++){
+            boxes.at(i).addPoint(vertex(i, corner));
+        }
+        // Pad the box so rays grazing the triangle aren't culled by floating point error, this also gives
+        // axis aligned triangles a box with some thickness
+        boxes.at(i).pad(EPSILON);
+    }
+
+    if(count > 0){
+        buildNode(boxes, 0, count, 0);
+    }
+
+    // Padded so the leaf kernel can always read MAX_LEAF_SIZE triangles
+    for(int corner = 0; corner < 3; corner++){
+        for(int axis = 0; axis < 3; axis++){
+            corners[corner][axis].assign(count + MAX_LEAF_SIZE - 1, 0);
+            for(int i = 0; i < count; i++){
+                corners[corner][axis][i] = component(vertex(order[i], corner), axis);
+            }
+        }
+    }
+}
+
+// Splits the triangles at the median centroid on the axis the centroids are most spread out on. The median
+// split keeps the tree balanced, which bounds its depth for meshes of any size
+int TriangleMesh::buildNode(const std::vector<BoundingBox> &boxes, int start, int end, int depth){
+    int index = nodes.size();
+    nodes.push_back(Node());
+
+    BoundingBox bounds;
+    BoundingBox centroidBounds;
+    for(int i = start; i < end; i++){
+        bounds.merge(boxes.at(order.at(i)));
+        centroidBounds.addPoint(boxes.at(order.at(i)).centroid());
+    }
+    nodes.at(index).bounds = bounds;
+
+    int count = end - start;
+    if(count <= MAX_LEAF_SIZE || depth >= MAX_DEPTH){
+        nodes.at(index).left = -1;
+        nodes.at(index).right = -1;
+        nodes.at(index).start = start;
+        nodes.at(index).count = count;
+        return index;
+    }
+
+    Vector extent = Vector(centroidBounds.getMax() - centroidBounds.getMin());
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    int mid = start + count/2;
+    std::nth_element(order.begin() + start, order.begin() + mid, order.begin() + end, [&](uint32_t a, uint32_t b){
+        return component(boxes.at(a).centroid(), axis) < component(boxes.at(b).centroid(), axis);
+    });
+
+    int left = buildNode(boxes, start, mid, depth + 1);
+    int right = buildNode(boxes, mid, end, depth + 1);
+    nodes.at(index).left = left;
+    nodes.at(index).right = right;
+    nodes.at(index).start = 0;
+    nodes.at(index).count = 0;
+    return index;
+}
+
+const Point& TriangleMesh::vertex(int i, int corner) const{
+    return vertices[indices[3*i + corner]];
+}
+
+// Same arithmetic as intersectTriangle. The ray's axis permutation picks the arrays each coordinate is read
+// from once per leaf, and the first loop always runs over MAX_LEAF_SIZE triangles into local arrays with
+// bitwise flags instead of branches, so the compiler turns it into SIMD code. The second loop applies the
+// flags, triangles with an edge function of exactly 0 are retested by intersectTriangle, which falls back
+// to double precision for them
+void TriangleMesh::intersectLeaf(const WatertightRay &r, int start, int count, float* times) const{
+    const float* x[3];
+    const float* y[3];
+    const float* z[3];
+    for(int corner = 0; corner < 3; corner++){
+        x[corner] = corners[corner][r.kx].data() + start;
+        y[corner] = corners[corner][r.ky].data() + start;
+        z[corner] = corners[corner][r.kz].data() + start;
+    }
+    float ox = component(r.origin, r.kx);
+    float oy = component(r.origin, r.ky);
+    float oz = component(r.origin, r.kz);
+
+    // Bit 0 is set if the ray misses the triangle, bit 1 if an edge function is exactly 0
+    float leafTimes[MAX_LEAF_SIZE];
+    int flags[MAX_LEAF_SIZE];
+    for(int k = 0; k < MAX_LEAF_SIZE; k++){
+        float az = z[0][k] - oz;
+        float bz = z[1][k] - oz;
+        float cz = z[2][k] - oz;
+        float ax = (x[0][k] - ox) - r.sx*az;
+        float ay = (y[0][k] - oy) - r.sy*az;
+        float bx = (x[1][k] - ox) - r.sx*bz;
+        float by = (y[1][k] - oy) - r.sy*bz;
+        float cx = (x[2][k] - ox) - r.sx*cz;
+        float cy = (y[2][k] - oy) - r.sy*cz;
+
+        float u = cx*by - cy*bx;
+        float v = ax*cy - ay*cx;
+        float w = bx*ay - by*ax;
+        float det = u + v + w;
+        bool outside = ((u < 0) | (v < 0) | (w < 0)) & ((u > 0) | (v > 0) | (w > 0));
+        bool onEdge = (u == 0) | (v == 0) | (w == 0);
+        leafTimes[k] = (u*r.sz*az + v*r.sz*bz + w*r.sz*cz)/det;
+        flags[k] = (outside | (det == 0)) | (onEdge << 1);
+    }
+
+    for(int k = 0; k < count; k++){
+        if(flags[k] & 2){
+            int i = order[start + k];
+            float t;
+            times[k] = intersectTriangle(r, vertex(i, 0), vertex(i, 1), vertex(i, 2), t) ? t : NAN;
+        }else{
+            times[k] = flags[k] & 1 ? NAN : leafTimes[k];
+        }
+        RENDER_STAT(TRIANGLE_TESTS);
+        if(!std::isnan(times[k])){
+            RENDER_STAT(TRIANGLE_HITS);
+        }
+    }
+}
+
+// Getters
+const std::vector<Point>& TriangleMesh::getVertices() const{
+    return vertices;
+}
+
+const std::vector<uint32_t>& TriangleMesh::getIndices() const{
+    return indices;
+}
+
+int TriangleMesh::getTriangleCount() const{
+    return indices.size()/3;
+}
+
+int TriangleMesh::getNodeCount() const{
+    return nodes.size();
+}
+
+const Vector& TriangleMesh::getE1(int triangle) const{
+    return edges.at(triangle).e1;
+}
+
+const Vector& TriangleMesh::getE2(int triangle) const{
+    return edges.at(triangle).e2;
+}
+
+const Vector& TriangleMesh::getNormal(int triangle) const{
+    return normals.at(triangle);
+}
+
+// Walks the tree with a stack, skipping every subtree whose box the ray misses
+void TriangleMesh::childIntersections(const Ray &r, std::vector<Intersection> &intersects){
+    if(nodes.empty()){
+        return;
+    }
+
+    WatertightRay wr(r);
+    int stack[MAX_DEPTH + 1];
+    int top = 0;
+    stack[top++] = 0;
+    while(top > 0){
+        const Node &node = nodes[stack[--top]];
+        if(!node.bounds.intersects(r)){
+            continue;
+        }
+
+        if(node.count > 0){
+            // A leaf can hold more than MAX_LEAF_SIZE triangles if MAX_DEPTH was reached
+            float times[MAX_LEAF_SIZE];
+            for(int start = node.start; start < node.start + node.count; start += MAX_LEAF_SIZE){
+                int count = std::min(node.start + node.count - start, (int)MAX_LEAF_SIZE);
+                intersectLeaf(wr, start, count, times);
+                for(int k = 0; k < count; k++){
+                    if(!std::isnan(times[k])){
+                        intersects.push_back(Intersection(times[k], this, order[start + k]));
+                    }
+                }
+            }
+        }else{
+            stack[top++] = node.right;
+            stack[top++] = node.left;
+        }
+    }
+}
+
+// Walks the tree nearest child first, lowering tMax every time a closer hit is found
+bool TriangleMesh::closestObjectIntersection(const Ray &objectRay, float tMin, float &tMax, Intersection &hit){
+    if(nodes.empty()){
+        return false;
+    }
+
+    WatertightRay wr(objectRay);
+    bool found = false;
+    int stack[MAX_DEPTH + 1];
+    int top = 0;
+    stack[top++] = 0;
+    while(top > 0){
+        const Node &node = nodes[stack[--top]];
+        if(!node.bounds.intersects(objectRay, tMin, tMax)){
+            continue;
+        }
+
+        if(node.count > 0){
+            float times[MAX_LEAF_SIZE];
+            for(int start = node.start; start < node.start + node.count; start += MAX_LEAF_SIZE){
+                int count = std::min(node.start + node.count - start, (int)MAX_LEAF_SIZE);
+                intersectLeaf(wr, start, count, times);
+                for(int k = 0; k < count; k++){
+                    if(times[k] >= tMin && times[k] < tMax){
+                        tMax = times[k];
+                        hit = Intersection(times[k], this, order[start + k]);
+                        found = true;
+                    }
+                }
+            }
+        }else{
+            // Pushes the farther child first so the nearer child is visited first
+            float leftEnter, rightEnter;
+            bool hitLeft = nodes[node.left].bounds.intersects(objectRay, tMin, tMax, leftEnter);
+            bool hitRight = nodes[node.right].bounds.intersects(objectRay, tMin, tMax, rightEnter);
+            if(hitLeft && hitRight){
+                if(leftEnter <= rightEnter){
+                    stack[top++] = node.right;
+                    stack[top++] = node.left;
+                }else{
+                    stack[top++] = node.left;
+                    stack[top++] = node.right;
+                }
+            }else if(hitLeft){
+                stack[top++] = node.left;
+            }else if(hitRight){
+                stack[top++] = node.right;
+            }
+        }
+    }
+
+    return found;
+}
+
+// Any hit query for shadow rays, the whole mesh has one material so it is checked before the walk
+bool TriangleMesh::objectOccludes(const Ray &objectRay, float tMin, float tMax){
+    if(nodes.empty() || !getMaterial().castsShadow){
+        return false;
+    }
+
+    WatertightRay wr(objectRay);
+    int stack[MAX_DEPTH + 1];
+    int top = 0;
+    stack[top++] = 0;
+    while(top > 0){
+        const Node &node = nodes[stack[--top]];
+        if(!node.bounds.intersects(objectRay, tMin, tMax)){
+            continue;
+        }
+
+        if(node.count > 0){
+            float times[MAX_LEAF_SIZE];
+            for(int start = node.start; start < node.start + node.count; start += MAX_LEAF_SIZE){
+                int count = std::min(node.start + node.count - start, (int)MAX_LEAF_SIZE);
+                intersectLeaf(wr, start, count, times);
+                for(int k = 0; k < count; k++){
+                    if(times[k] > tMin && times[k] < tMax){
+                        return true;
+                    }
+                }
+            }
+        }else{
+            stack[top++] = node.right;
+            stack[top++] = node.left;
+        }
+    }
+
+    return false;
+}
+
+// Finds the triangle whose plane is closest to p among the triangles p is inside of when projected onto
+// their plane, using the barycentric coordinates from the precomputed edges
+Vector TriangleMesh::childNormal(const Point &p){
+    int best = -1;
+    float bestDistance = INFINITY;
+    for(int i = 0; i < getTriangleCount(); i++){
+        const Vector &e1 = edges[i].e1;
+        const Vector &e2 = edges[i].e2;
+        Vector d = Vector(p - vertex(i, 0));
+        float distance = std::abs(dotProduct(d, normals[i]));
+        if(distance >= bestDistance){
+            continue;
+        }
+
+        float d11 = dotProduct(e1, e1);
+        float d12 = dotProduct(e1, e2);
+        float d22 = dotProduct(e2, e2);
+        float denom = d11*d22 - d12*d12;
+        if(denom == 0){
+            continue;
+        }
+        float v = (d22*dotProduct(d, e1) - d12*dotProduct(d, e2))/denom;
+        float w = (d11*dotProduct(d, e2) - d12*dotProduct(d, e1))/denom;
+        if(v >= -EPSILON && w >= -EPSILON && v + w <= 1 + EPSILON){
+            best = i;
+            bestDistance = distance;
+        }
+    }
+
+    if(best == -1){
+        return Vector(0, 0, 0);
+    }
+    return normals[best];
+}
+
+Vector TriangleMesh::childHitNormal(const Point &p, const Intersection &hit){
+    if(hit.getIndex() >= 0 && hit.getIndex() < getTriangleCount()){
+        return normals[hit.getIndex()];
+    }
+    return childNormal(p);
+}
+
+// Box around every vertex used by a triangle, unused vertices in the buffer are ignored
+BoundingBox TriangleMesh::childBounds(){
+    BoundingBox bounds;
+    for(int i = 0; i < indices.size(); i++){
+        bounds.addPoint(vertices[indices[i]]);
+    }
+    return bounds;
+}
@@ -1,5 +1,8 @@
 #include "Tuple.h"
 
+// The SIMD code loads x, y, z and point as one 16 byte block
+static_assert(sizeof(Tuple) == 16, "Tuple must be exactly four packed floats");
+
 // Tuple constructors
 Tuple::Tuple(){
     this->x = 0;
@@ -15,42 +18,89 @@ Tuple::Tuple(float x, float y, float z, float point){
     this->point = point;
 }
 
+#ifdef TUPLE_SIMD
+// Constructs a tuple from a SIMD register storing (x, y, z, point)
+Tuple::Tuple(__m128 v){
+    _mm_store_ps(&x, v);
+}
+
+// Loads the tuple into a SIMD register
+__m128 Tuple::toSIMD() const{
+    return _mm_load_ps(&x);
+}
+
+// Sums the four lanes of v, returns the sum in every lane
+static __m128 horizontalSum(__m128 v){
+    __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuffled);
+    shuffled = _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 0, 3, 2));
+    return _mm_add_ps(sums, shuffled);
+}
+#endif
+
 // Checks if another tuple is equal to self
-bool Tuple::isEqual(Tuple a){
+bool Tuple::isEqual(const Tuple &a) const{
+#ifdef TUPLE_SIMD
+    // |this - a| < EPSILON for every component, abs is computed by clearing the sign bit
+    __m128 diff = _mm_sub_ps(toSIMD(), a.toSIMD());
+    diff = _mm_andnot_ps(_mm_set1_ps(-0.0f), diff);
+    return _mm_movemask_ps(_mm_cmplt_ps(diff, _mm_set1_ps(EPSILON))) == 0xF;
+#else
     if(!floatIsEqual(x, a.x) || !floatIsEqual(y, a.y) || !floatIsEqual(z, a.z) || !floatIsEqual(point, a.point)){
         return false;
     }
 
     return true;
+#endif
 }
 
 // Adds tuples together. Adding a vector and point together is equivalent to starting from that point and travelling
 // the distance and direction of the vector, also notice that a point(1) + vector(0) results in another point! Adding
 // two vectors results in another vector(0 + 0 = 0)! Adding two points results in 1 + 1 = 2 (invalid)
-Tuple Tuple::operator+(Tuple b){
+Tuple Tuple::operator+(const Tuple &b) const{
+#ifdef TUPLE_SIMD
+    return Tuple(_mm_add_ps(toSIMD(), b.toSIMD()));
+#else
     return Tuple(x + b.x, y + b.y, z + b.z, point + b.point);
+#endif
 };
 
 // Performs a - b. Intuitively, subtracting a point from a point generates a vector from p2 to p1. Subtracting a point
 // from a vector moves the point back the vector's distance and direction. Subtracting two vectors represents the change
 // in direction between the two.
-Tuple Tuple::operator-(Tuple b){
+Tuple Tuple::operator-(const Tuple &b) const{
+#ifdef TUPLE_SIMD
+    return Tuple(_mm_sub_ps(toSIMD(), b.toSIMD()));
+#else
     return Tuple(x - b.x, y - b.y, z - b.z, point - b.point);
+#endif
 }
 
 // Multiplies a tuple by a factor of scale
-Tuple Tuple::operator*(float scale){
+Tuple Tuple::operator*(float scale) const{
+#ifdef TUPLE_SIMD
+    return Tuple(_mm_mul_ps(toSIMD(), _mm_set1_ps(scale)));
+#else
     return Tuple(x*scale, y*scale, z*scale, point*scale);
+#endif
 }
 
 // Divides a tuple by scale
-Tuple Tuple::operator/(float scale){
+Tuple Tuple::operator/(float scale) const{
+#ifdef TUPLE_SIMD
+    return Tuple(_mm_div_ps(toSIMD(), _mm_set1_ps(scale)));
+#else
     return Tuple(x/scale, y/scale, z/scale, point/scale);
+#endif
 }
 
 // Negates a tuple. Flipping direction of a vector
-Tuple Tuple::negateTuple(){
+Tuple Tuple::negateTuple() const{
+#ifdef TUPLE_SIMD
+    return Tuple(_mm_xor_ps(toSIMD(), _mm_set1_ps(-0.0f)));
+#else
     return Tuple(-x, -y, -z, -point);
+#endif
 }
 
 // Point constructors
@@ -58,36 +108,55 @@ Point::Point(): Tuple(0, 0, 0, 1.0) {}
 
 Point::Point(float x, float y, float z): Tuple(x, y, z, 1.0) {}
 
-Point::Point(Tuple t): Tuple(t.x, t.y, t.z, 1.0) {}
+Point::Point(const Tuple &t): Tuple(t.x, t.y, t.z, 1.0) {}
 
 // Vector constructors
 Vector::Vector(): Tuple(1, 1, 1, 0.0) {}
 
 Vector::Vector(float x, float y, float z): Tuple(x, y, z, 0.0) {}
 
-Vector::Vector(Tuple t): Tuple(t.x, t.y, t.z, 0.0) {}
+Vector::Vector(const Tuple &t): Tuple(t.x, t.y, t.z, 0.0) {}
 
 // NOTE!! Point is included in these vector operations to hopefully help if there
 // are any bugs later as point should always be 0 so it will have no effect on these
 
 // Calculates magnitude of vector
-float Vector::magnitude(){
-    return sqrt(x*x + y*y + z*z + point*point);
+float Vector::magnitude() const{
+    return sqrt(dotProduct(*this, *this));
 }
 
 // Normalizes vector so it's magnitude = 1
-Vector Vector::normalize(){
+Vector Vector::normalize() const{
     float mag = magnitude();
 
+#ifdef TUPLE_SIMD
+    return Vector(Tuple(_mm_div_ps(toSIMD(), _mm_set1_ps(mag))));
+#else
     return Vector(x/mag, y/mag, z/mag);
+#endif
 }
 
 // Calculates dot product of vectors a and b
-float dotProduct(Vector a, Vector b){
+float dotProduct(const Vector &a, const Vector &b){
+#ifdef TUPLE_SIMD
+    return _mm_cvtss_f32(horizontalSum(_mm_mul_ps(a.toSIMD(), b.toSIMD())));
+#else
     return a.x*b.x + a.y*b.y + a.z*b.z + a.point*b.point;
+#endif
 }
 
 // Calculates cross product of vectors a and b
-Vector crossProduct(Vector a, Vector b){
+Vector crossProduct(const Vector &a, const Vector &b){
+#ifdef TUPLE_SIMD
+    // (a.yzx*b.zxy - a.zxy*b.yzx), the point lane cancels out to 0
+    __m128 va = a.toSIMD();
+    __m128 vb = b.toSIMD();
+    __m128 a_yzx = _mm_shuffle_ps(va, va, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 b_yzx = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 a_zxy = _mm_shuffle_ps(va, va, _MM_SHUFFLE(3, 1, 0, 2));
+    __m128 b_zxy = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 1, 0, 2));
+    return Vector(Tuple(_mm_sub_ps(_mm_mul_ps(a_yzx, b_zxy), _mm_mul_ps(a_zxy, b_yzx))));
+#else
     return Vector(a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x);
-}
\ No newline at end of file
+#endif
+}
@@ -6,58 +6,102 @@ World::World(){
 }
 
 // Gets the list of objects in the world
-std::vector<Shape*> World::getObjects(){
+const std::vector<Shape*>& World::getObjects() const{
     return objects;
 }
 
 // Gets the light source in the world
-LightSource World::getLight(){
+const LightSource& World::getLight() const{
     return light;
 }
 
 // Adds an object to the world
 void World::appendObject(Shape* s){
     objects.push_back(s);
+    bvhBuilt = false;
 }
 
 // Sets the light source
-void World::setLight(LightSource l){
+void World::setLight(const LightSource &l){
     light = l;
 }
 
 // Sets the objects in the world
 void World::setObjects(std::vector<Shape*> obj){
-    objects = obj;
+    objects = std::move(obj);
+    bvhBuilt = false;
+}
+
+// Builds the BVH so RayIntersection only tests objects whose bounds the ray passes through. The BVH is
+// built over the primitives inside groups rather than the groups, so a ray is tested against each primitive
+// in world space with one transform instead of one per level of nesting, and the intersections inside a
+// group are no longer sorted separately
+void World::buildBVH(){
+    RENDER_STAGE_TIMER(STAGE_BVH_BUILD);
+    primitives.clear();
+    Matrix4 identity;
+    for(int i = 0; i < objects.size(); i++){
+        objects.at(i)->commitTransforms(identity, identity, primitives);
+    }
+    bvh = BVH(primitives);
+    bvhBuilt = true;
+}
+
+const std::vector<Shape*>& World::getPrimitives() const{
+    return primitives;
+}
+
+bool World::hasBVH() const{
+    return bvhBuilt;
 }
 
 // Returns a vector of intersections where the ray intersects the surface of the objects in the world
-std::vector<Intersection> World::RayIntersection(Ray r){
-    // Initializes the intersection vectors needed to compute the intersections
+std::vector<Intersection> World::RayIntersection(const Ray &r) const{
     std::vector<Intersection> intersects;
-    std::vector<Intersection> temp;
+    RayIntersection(r, intersects);
+    return intersects;
+}
+
+// Fills intersects with the sorted intersections of the ray, the vector's capacity is kept so a buffer
+// reused between rays stops allocating once it has grown large enough
+void World::RayIntersection(const Ray &r, std::vector<Intersection> &intersects) const{
+    intersects.clear();
 
     // Adds the intersections of all the objects with the ray into
-    // the intersects vector
-    for(int i = 0; i < objects.size(); i++){
-        temp = objects.at(i)->findIntersections(r);
-        for(int j = 0; j < temp.size(); j++){
-            intersects.push_back(temp.at(j));
+    // the intersects vector. The BVH skips objects the ray can't hit
+    if(bvhBuilt){
+        bvh.intersect(r, intersects);
+    }else{
+        for(int i = 0; i < objects.size(); i++){
+            objects.at(i)->findIntersections(r, intersects);
         }
     }
 
     std::sort(intersects.begin(), intersects.end(), compareIntersections);
+}
 
-    return intersects;
+// Finds the nearest intersection in [tMin, tMax), each object rejects hits beyond the closest one found so far
+bool World::closestHit(const Ray &r, Intersection &hit, float tMin, float tMax) const{
+    if(bvhBuilt){
+        return bvh.closestHit(r, hit, tMin, tMax);
+    }
+
+    bool found = false;
+    for(int i = 0; i < objects.size(); i++){
+        found = objects.at(i)->closestIntersection(r, tMin, tMax, hit) || found;
+    }
+
+    return found;
 }
 
 // Returns the computed colour of a hit using the world light source and the LightData data structure
-Colour World::shadeHit(LightData data, int remaining){
-    bool shadowed = data.object->getMaterial().castsShadow && hasShadow(data.overPoint);
-    Colour surfaceCol = computeLighting(data.object->getMaterial(), data.object, light, data.overPoint, data.camera, data.normal, shadowed);
+Colour World::shadeHit(const LightData &data, int remaining) const{
+    const Material &m = data.object->getMaterial();
+    bool shadowed = m.castsShadow && hasShadow(data.overPoint);
+    Colour surfaceCol = computeLighting(m, data.object, light, data.overPoint, data.camera, data.normal, shadowed);
     Colour reflectedCol = reflectedColour(data, remaining);
     Colour refractedCol = refractedColour(data, remaining);
 
-    Material m = data.object->getMaterial();
     if(m.reflective > 0 && m.transparency > 0){
         float reflectance = schlickApproximation(data);
         return surfaceCol + reflectedCol*reflectance + refractedCol*(1 - reflectance);
@@ -67,33 +111,29 @@ Colour World::shadeHit(LightData data, int remaining){
 }
 
 // Computes the colour at the first point hit by the ray r
-Colour World::colourAtHit(Ray r, int remaining){
-    // Find intersections of ray at hit
-    std::vector<Intersection> intersects = this->RayIntersection(r);
-
-    if(intersects.size() == 0){
+Colour World::colourAtHit(const Ray &r, int remaining) const{
+    // Find the first object hit by the ray
+    Intersection hit(INFINITY, nullptr);
+    if(!this->closestHit(r, hit)){
         return Colour();
     }
 
-    int ind = -1;
-    for(int i = 0; i < intersects.size(); i++){
-        if(intersects.at(i).getTime() >= 0){
-            ind = i;
-            break;
-        }
-    }
-
-    if(ind == -1){
-        return Colour();
+    // The refractive indices are only needed for transparent objects, which is the only
+    // case where the full sorted list of intersections has to be built. The list is only read
+    // by prepareLightData, so one buffer per thread is reused for every ray including recursive ones
+    static thread_local std::vector<Intersection> rayIntersects;
+    LightData data;
+    if(hit.getShape()->getMaterial().transparency > 0){
+        this->RayIntersection(r, rayIntersects);
+        data = prepareLightData(hit, r, rayIntersects);
+    }else{
+        data = prepareLightData(hit, r);
     }
-
-    // Uses object that is hit first
-    LightData data = prepareLightData(intersects.at(ind), r, intersects);
     return this->shadeHit(data, remaining);
 }
 
 // Checks if a point has an object covering the light source
-bool World::hasShadow(Point p){
+bool World::hasShadow(const Point &p) const{
     if(!RENDER_SHADOWS){
         return false;
     }
@@ -102,23 +142,30 @@ bool World::hasShadow(Point p){
     float distance = v.magnitude();
     Vector direction = v.normalize();
 
+    // Any object between the point and the light blocks it, so the search stops at the first one
+    // instead of finding and sorting every intersection
+    RENDER_STAT(SHADOW_RAYS);
     Ray r(p, direction);
-    std::vector<Intersection> intersects = this->RayIntersection(r);
+    if(bvhBuilt){
+        return bvh.occluded(r, EPSILON, distance);
+    }
 
-    int ind = hit(intersects);
-    if(ind != -1 && intersects.at(ind).getTime() < distance){
-        return true;
-    }else{
-        return false;
+    for(int i = 0; i < objects.size(); i++){
+        if(objects.at(i)->occludes(r, EPSILON, distance)){
+            return true;
+        }
     }
+
+    return false;
 }
 
 // Computes colour of a reflective surface in the world when it is hit by a ray
-Colour World::reflectedColour(LightData data, int remaining){
+Colour World::reflectedColour(const LightData &data, int remaining) const{
     if(data.object->getMaterial().reflective == 0 || remaining <= 0){
         return BLACK;
     }
 
+    RENDER_STAT(REFLECTION_RAYS);
     Ray reflectRay(data.overPoint, data.reflect);
     Colour c = colourAtHit(reflectRay, remaining - 1);
 
@@ -126,7 +173,7 @@ Colour World::reflectedColour(LightData data, int remaining){
 }
 
 // Computes colour of a surface when hit by a ray based on the material's transparency and refractive properties
-Colour World::refractedColour(LightData data, int remaining){
+Colour World::refractedColour(const LightData &data, int remaining) const{
     if(data.object->getMaterial().transparency == 0 || remaining == 0){
         return BLACK;
     }
@@ -149,6 +196,7 @@ Colour World::refractedColour(LightData data, int remaining){
     double cos_t = sqrt(1.0 - sin2_t);
     // Compute direction of refracted ray
     Vector direction = data.normal*(n_ratio*cos_i - cos_t) - data.camera*n_ratio;
+    RENDER_STAT(REFRACTION_RAYS);
     Ray refractedRay(data.underPoint, direction);
     // Finds colour of refracted ray
     Colour c = colourAtHit(refractedRay, remaining - 1)*data.object->getMaterial().transparency;
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "World.h"
+#include "Camera.h"
+#include "Shape.h"
+#include "Group.h"
+#include "Pattern.h"
+#include "Matrix.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Counts every heap allocation made by the test binary so the per ray path can be checked for allocations
+static std::atomic<long> allocationCount(0);
+
+void* operator new(std::size_t size){
+    allocationCount++;
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if(p == nullptr){
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t size) noexcept{
+    std::free(p);
+}
+
+// Scene with every shape type, a group, a reflective surface and a glass sphere so that every intersection
+// kernel, the refraction path and the BVH are all used
+static World allocationTestWorld(){
+    World w;
+    w.setLight(LightSource(Point(-10, 10, -10), Colour(1, 1, 1)));
+
+    Plane* floor = new Plane;
+    Material m;
+    m.pattern = new CheckerPattern({WHITE, Colour(0.1, 0.3, 0.9)});
+    m.reflective = 0.3;
+    floor->setMaterial(m);
+    floor->setTransform(translationMatrix(0, -1, 0));
+    w.appendObject(floor);
+
+    Sphere* glass = new Sphere;
+    m = Material();
+    m.transparency = 0.9;
+    m.reflective = 0.9;
+    m.refractiveIndex = 1.5;
+    glass->setMaterial(m);
+    w.appendObject(glass);
+
+    Group* g = new Group;
+    g->setTransform(translationMatrix(2, 0, 1));
+    Cube* cube = new Cube;
+    cube->setTransform(scalingMatrix(0.5, 0.5, 0.5));
+    Cylinder* cylinder = new Cylinder;
+    cylinder->setClosed(true);
+    cylinder->setMaxH(1);
+    cylinder->setTransform(translationMatrix(-4, 0, 0));
+    Cone* cone = new Cone;
+    cone->setClosed(true);
+    cone->setMinH(-1);
+    cone->setTransform(translationMatrix(-2, 0, 2));
+    g->appendShape(cube);
+    g->appendShape(cylinder);
+    g->appendShape(cone);
+    w.appendObject(g);
+
+    w.buildBVH();
+    return w;
+}
+
+TEST(Allocation_colourAtHitTest, RenderingAPixelAfterWarmUpDoesNotAllocate){
+    World w = allocationTestWorld();
+    Camera c(40, 20, PI/3);
+    c.setTransform(viewTransformationMatrix(Point(0, 1.5, -5), Point(0, 0, 0), Vector(0, 1, 0)));
+
+    // The first pass grows the per thread buffers to the size the scene needs
+    for(int y = 0; y < 20; y++){
+        for(int x = 0; x < 40; x++){
+            w.colourAtHit(c.rayToPixel(x, y));
+        }
+    }
+
+    long before = allocationCount.load();
+    for(int y = 0; y < 20; y++){
+        for(int x = 0; x < 40; x++){
+            w.colourAtHit(c.rayToPixel(x, y));
+        }
+    }
+    long after = allocationCount.load();
+
+    EXPECT_EQ(after - before, 0);
+}
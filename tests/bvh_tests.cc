@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include "BVH.h"
+#include "BoundingBox.h"
+#include "Shape.h"
+#include "Group.h"
+#include "World.h"
+#include <vector>
+#include <algorithm>
+
+TEST(BoundingBoxTest, DefaultBoxIsEmpty){
+    BoundingBox b;
+
+    EXPECT_TRUE(b.isEmpty());
+    EXPECT_FALSE(b.intersects(Ray(Point(), Vector(0, 0, 1))));
+}
+
+TEST(BoundingBox_addPointTest, BoxGrowsToContainPoints){
+    BoundingBox b;
+
+    b.addPoint(Point(-5, 2, 0));
+    b.addPoint(Point(7, 0, -3));
+
+    EXPECT_TRUE(b.getMin().isEqual(Point(-5, 0, -3)));
+    EXPECT_TRUE(b.getMax().isEqual(Point(7, 2, 0)));
+    EXPECT_TRUE(b.centroid().isEqual(Point(1, 1, -1.5)));
+    EXPECT_TRUE(floatIsEqual(b.surfaceArea(), 2*(12*2 + 2*3 + 3*12)));
+}
+
+TEST(BoundingBox_transformTest, RotatedBoxContainsAllCorners){
+    BoundingBox b(Point(-1, -1, -1), Point(1, 1, 1));
+
+    BoundingBox result = b.transform(translationMatrix(1, 0, 0)*yRotationMatrix(PI/4));
+
+    EXPECT_TRUE(result.getMin().isEqual(Point(1 - sqrt(2), -1, -sqrt(2))));
+    EXPECT_TRUE(result.getMax().isEqual(Point(1 + sqrt(2), 1, sqrt(2))));
+}
+
+TEST(BoundingBox_transformTest, InfiniteBoxStaysInfinite){
+    BoundingBox b(Point(-INFINITY, 0, -INFINITY), Point(INFINITY, 0, INFINITY));
+
+    BoundingBox result = b.transform(xRotationMatrix(PI/2));
+
+    EXPECT_FALSE(result.isFinite());
+    EXPECT_TRUE(result.intersects(Ray(Point(0, 5, 0), Vector(1, 0, 0))));
+}
+
+TEST(BoundingBox_intersectsTest, RayHitsAndMissesBox){
+    BoundingBox b(Point(-1, -1, -1), Point(1, 1, 1));
+
+    EXPECT_TRUE(b.intersects(Ray(Point(5, 0.5, 0), Vector(-1, 0, 0))));
+    EXPECT_TRUE(b.intersects(Ray(Point(0, 0, 0), Vector(0, 0, 1))));
+    EXPECT_FALSE(b.intersects(Ray(Point(-2, 0, 0), Vector(2, 4, 6))));
+    EXPECT_FALSE(b.intersects(Ray(Point(2, 2, 0), Vector(0, 0, 1))));
+    // Box is behind the ray, only hit if negative times are allowed
+    EXPECT_TRUE(b.intersects(Ray(Point(0, 0, 5), Vector(0, 0, 1))));
+    EXPECT_FALSE(b.intersects(Ray(Point(0, 0, 5), Vector(0, 0, 1)), 0, INFINITY));
+}
+
+TEST(Shape_getBoundsTest, BoundsOfEachShape){
+    Sphere s;
+    s.setTransform(translationMatrix(1, 2, 3)*scalingMatrix(2, 2, 2));
+    EXPECT_TRUE(s.getBounds().getMin().isEqual(Point(-1, 0, 1)));
+    EXPECT_TRUE(s.getBounds().getMax().isEqual(Point(3, 4, 5)));
+
+    Cube c;
+    EXPECT_TRUE(c.getBounds().getMin().isEqual(Point(-1, -1, -1)));
+    EXPECT_TRUE(c.getBounds().getMax().isEqual(Point(1, 1, 1)));
+
+    Plane p;
+    EXPECT_FALSE(p.getBounds().isFinite());
+
+    Cylinder cyl;
+    EXPECT_FALSE(cyl.getBounds().isFinite());
+    cyl.setMinH(-2);
+    cyl.setMaxH(3);
+    EXPECT_TRUE(cyl.getBounds().getMin().isEqual(Point(-1, -2, -1)));
+    EXPECT_TRUE(cyl.getBounds().getMax().isEqual(Point(1, 3, 1)));
+
+    Cone cone;
+    cone.setMinH(-5);
+    cone.setMaxH(3);
+    EXPECT_TRUE(cone.getBounds().getMin().isEqual(Point(-5, -5, -5)));
+    EXPECT_TRUE(cone.getBounds().getMax().isEqual(Point(5, 3, 5)));
+}
+
+TEST(Group_childBoundsTest, GroupBoundsContainTransformedChildren){
+    Group* g = new Group;
+    Sphere* s1 = new Sphere;
+    s1->setTransform(translationMatrix(2, 0, 0));
+    Sphere* s2 = new Sphere;
+    s2->setTransform(translationMatrix(0, 0, -3));
+    g->appendShape(s1);
+    g->appendShape(s2);
+    g->setTransform(scalingMatrix(2, 2, 2));
+
+    BoundingBox b = g->getBounds();
+
+    EXPECT_TRUE(b.getMin().isEqual(Point(-2, -2, -8)));
+    EXPECT_TRUE(b.getMax().isEqual(Point(6, 2, 2)));
+}
+
+// Sorts intersections by time and then by shape so two lists can be compared
+static void sortIntersections(std::vector<Intersection> &v){
+    std::sort(v.begin(), v.end(), [](Intersection a, Intersection b){
+        if(a.getTime() != b.getTime()){
+            return a.getTime() < b.getTime();
+        }
+        return a.getShape() < b.getShape();
+    });
+}
+
+TEST(BVH_intersectTest, MatchesTestingEveryShape){
+    std::vector<Shape*> objects;
+    for(int x = 0; x < 10; x++){
+        for(int z = 0; z < 10; z++){
+            Shape* s;
+            if((x + z) % 2 == 0){
+                s = new Sphere;
+            }else{
+                s = new Cube;
+            }
+            s->setTransform(translationMatrix(x*3 - 15, (x*z) % 4, z*3 - 15)*scalingMatrix(0.8, 0.8, 0.8));
+            objects.push_back(s);
+        }
+    }
+    Plane* floor = new Plane;
+    floor->setTransform(translationMatrix(0, -1, 0));
+    objects.push_back(floor);
+
+    BVH bvh(objects);
+    EXPECT_GT(bvh.getNodeCount(), 1);
+    EXPECT_EQ(bvh.getUnbounded().size(), 1);
+
+    std::vector<Ray> rays = {Ray(Point(-20, 0.5, -15), Vector(1, 0, 0)), Ray(Point(0, 10, 0), Vector(0.1, -1, 0.3)),
+                             Ray(Point(-16, 1, -16), Vector(1, 0.01, 1).normalize()), Ray(Point(0, 0, 0), Vector(0, 0, 1)),
+                             Ray(Point(50, 50, 50), Vector(0, 1, 0))};
+    for(int i = 0; i < rays.size(); i++){
+        std::vector<Intersection> expected;
+        for(int j = 0; j < objects.size(); j++){
+            std::vector<Intersection> temp = objects.at(j)->findIntersections(rays.at(i));
+            expected.insert(expected.end(), temp.begin(), temp.end());
+        }
+        std::vector<Intersection> result;
+        bvh.intersect(rays.at(i), result);
+
+        sortIntersections(expected);
+        sortIntersections(result);
+        ASSERT_EQ(result.size(), expected.size());
+        for(int j = 0; j < result.size(); j++){
+            EXPECT_TRUE(result.at(j).isEqual(expected.at(j)));
+        }
+    }
+
+    for(int i = 0; i < objects.size(); i++){
+        delete objects.at(i);
+    }
+}
+
+TEST(World_RayIntersectionTest, BVHGivesSameIntersections){
+    World w = defaultWorld();
+    Ray r(Point(0, 0, -5), Vector(0, 0, 1));
+    std::vector<Intersection> expected = w.RayIntersection(r);
+
+    w.buildBVH();
+    std::vector<Intersection> result = w.RayIntersection(r);
+
+    EXPECT_TRUE(w.hasBVH());
+    ASSERT_EQ(result.size(), expected.size());
+    for(int i = 0; i < result.size(); i++){
+        EXPECT_TRUE(result.at(i).isEqual(expected.at(i)));
+    }
+
+    // Changing the objects clears the BVH
+    w.appendObject(new Sphere);
+    EXPECT_FALSE(w.hasBVH());
+}
+
+TEST(World_buildBVHTest, GroupsAreFlattenedIntoPrimitives){
+    World w = defaultWorld();
+    Group* outer = new Group;
+    outer->setTransform(translationMatrix(0, 0, 4)*yRotationMatrix(PI/4));
+    Group* inner = new Group;
+    inner->setTransform(scalingMatrix(0.5, 0.5, 0.5));
+    Cube* c = new Cube;
+    Sphere* s = new Sphere;
+    s->setTransform(translationMatrix(0, 3, 0));
+    inner->appendShape(c);
+    inner->appendShape(s);
+    outer->appendShape(inner);
+    w.appendObject(outer);
+
+    std::vector<Ray> rays({Ray(Point(0, 0, -5), Vector(0, 0, 1)), Ray(Point(0, 0.75, -5), Vector(0, 0, 1)),
+        Ray(Point(0.3, 0.2, -5), Vector(0, 0.05, 1).normalize())});
+    std::vector<std::vector<Intersection>> expected;
+    for(int i = 0; i < rays.size(); i++){
+        expected.push_back(w.RayIntersection(rays.at(i)));
+    }
+
+    w.buildBVH();
+
+    // The two spheres of the default world plus the cube and sphere inside the groups
+    EXPECT_EQ(w.getPrimitives().size(), 4);
+    for(int i = 0; i < rays.size(); i++){
+        std::vector<Intersection> result = w.RayIntersection(rays.at(i));
+        ASSERT_EQ(result.size(), expected.at(i).size());
+        for(int j = 0; j < result.size(); j++){
+            EXPECT_TRUE(result.at(j).isEqual(expected.at(i).at(j)));
+        }
+    }
+}
@@ -31,6 +31,16 @@ TEST(CameraTest, RayToPixelTest){
     EXPECT_TRUE(r.getDirection().isEqual(Vector(sqrt(2)/2, 0, -sqrt(2)/2)));
 }
 
+TEST(CameraTest, SetTransformUpdatesInverse){
+    Camera c(201, 101, PI/2);
+    EXPECT_TRUE(c.getInverseTransform().isEqual(Matrix(4)));
+
+    c.setTransform(translationMatrix(0, -2, 5));
+    EXPECT_TRUE(c.getInverseTransform().isEqual(translationMatrix(0, 2, -5)));
+    Ray r = c.rayToPixel(100, 50);
+    EXPECT_TRUE(r.getOrigin().isEqual(Point(0, 2, -5)));
+}
+
 TEST(CameraTest, RenderTest){
     World w = defaultWorld();
     Camera c(11, 11, PI/2);
@@ -42,4 +52,24 @@ TEST(CameraTest, RenderTest){
     Canvas image = c.render(w);
     Colour a = image.pixelColour(5, 5);
     EXPECT_TRUE(a.isEqual(Colour(0.38066, 0.47583, 0.2855)));
-}
\ No newline at end of file
+}
+
+TEST(CameraTest, RenderParallel_MatchesSerialRender){
+    World w = defaultWorld();
+    // Size is not a multiple of the tile size so the edge tiles are partial
+    Camera c(37, 21, PI/2);
+    c.setTransform(viewTransformationMatrix(Point(0, 0, -5), Point(), Vector(0, 1, 0)));
+
+    Canvas serial = c.render(w);
+    Canvas parallel = c.renderParallel(w, 4);
+
+    for(int y = 0; y < c.getVSize(); y++){
+        for(int x = 0; x < c.getHSize(); x++){
+            Colour a = serial.pixelColour(x, y);
+            Colour b = parallel.pixelColour(x, y);
+            EXPECT_EQ(a.r, b.r);
+            EXPECT_EQ(a.g, b.g);
+            EXPECT_EQ(a.b, b.b);
+        }
+    }
+}
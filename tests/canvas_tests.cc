@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 #include "Canvas.h"
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
 
 TEST(CanvasTests, BasicTest){
     Canvas a(10, 20);
@@ -44,6 +48,39 @@ TEST(CanvasTests, SetAllPixels){
     }
 }
 
+TEST(CanvasTests, PixelColourOutsideCanvasThrows){
+    Canvas a(10, 20);
+
+    EXPECT_THROW(a.pixelColour(10, 0), std::invalid_argument);
+    EXPECT_THROW(a.pixelColour(0, -1), std::invalid_argument);
+}
+
+TEST(CanvasTests, BufferIsContiguousAndAligned){
+    Canvas a(10, 20);
+
+    ColourSpan all = a.pixelSpan();
+    EXPECT_EQ(all.size(), 200);
+    EXPECT_EQ(a.getStride(), 10);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(all.data()) % CACHE_LINE_SIZE, 0);
+    EXPECT_EQ(&a.pixel(3, 2), all.data() + 2*a.getStride() + 3);
+}
+
+TEST(CanvasTests, RowViewWritesToCanvas){
+    Canvas a(10, 20);
+    Colour red(1, 0, 0);
+
+    ColourSpan row = a.row(4);
+    EXPECT_EQ(row.size(), 10);
+    for(Colour &c : row){
+        c = red;
+    }
+
+    EXPECT_TRUE(a.pixelColour(0, 4).isEqual(red));
+    EXPECT_TRUE(a.pixelColour(9, 4).isEqual(red));
+    EXPECT_TRUE(a.pixelColour(0, 5).isEqual(Colour(0, 0, 0)));
+    EXPECT_THROW(a.row(20), std::invalid_argument);
+}
+
 TEST(PPMTests, BasicOutput){
     Canvas a(5, 3);
 
@@ -60,4 +97,178 @@ TEST(PPMTests, LineCharacterLimit){
     a.setAllPixels(Colour(1, 0.8, 0.6));
 
     EXPECT_EQ(a.toPPM(), "P3\n10 2\n255\n255 204 153 255 204 153 255 204 153 255 204 153 255 204 153 255 204\n153 255 204 153 255 204 153 255 204 153 255 204 153\n255 204 153 255 204 153 255 204 153 255 204 153 255 204 153 255 204\n153 255 204 153 255 204 153 255 204 153 255 204 153\n");
-}
\ No newline at end of file
+}
+
+TEST(PPMTests, P6Output){
+    Canvas a(2, 2);
+    a.write_pixel(0, 0, Colour(1.5, 0, 0));
+    a.write_pixel(1, 0, Colour(0, 0.5, 0));
+    a.write_pixel(1, 1, Colour(-0.5, 0, 1));
+
+    std::ostringstream out;
+    a.writeP6(out);
+
+    std::string expected = std::string("P6\n2 2\n255\n") + std::string({char(255), 0, 0, 0, char(128), 0, 0, 0, 0, 0, 0, char(255)});
+    EXPECT_EQ(out.str(), expected);
+}
+
+TEST(PPMTests, P6SixteenBitOutputIsBigEndian){
+    Canvas a(1, 1);
+    a.write_pixel(0, 0, Colour(1, 0.5, 0));
+
+    std::ostringstream out;
+    a.writeP6(out, 65535);
+
+    // 0.5*65535 rounds up to 32768 = 0x8000
+    std::string expected = std::string("P6\n1 1\n65535\n") + std::string({char(0xFF), char(0xFF), char(0x80), 0, 0, 0});
+    EXPECT_EQ(out.str(), expected);
+}
+
+TEST(PPMTests, P6InvalidMaxvalThrows){
+    Canvas a(1, 1);
+    std::ostringstream out;
+
+    EXPECT_THROW(a.writeP6(out, 0), std::invalid_argument);
+    EXPECT_THROW(a.writeP6(out, 65536), std::invalid_argument);
+}
+
+// Every channel takes one byte instead of up to 4 characters in P3
+TEST(PPMTests, P6IsSmallerThanP3){
+    Canvas a(64, 64);
+    a.setAllPixels(Colour(1, 0.8, 0.6));
+
+    std::ostringstream out;
+    a.writeP6(out);
+
+    EXPECT_LT(out.str().size()*3, a.toPPM().size());
+}
+
+// Rows are formatted in blocks on different threads, the joined output must not depend on the thread count
+TEST(PPMTests, ParallelOutputMatchesSingleThread){
+    Canvas a(37, 53);
+    for(int y = 0; y < a.getHeight(); y++){
+        for(int x = 0; x < a.getWidth(); x++){
+            a.write_pixel(x, y, Colour(1.0*x/a.getWidth(), 1.0*y/a.getHeight(), (x*y % 7)/6.0));
+        }
+    }
+
+    std::string single = a.toPPM(1);
+
+    EXPECT_EQ(a.toPPM(4), single);
+    EXPECT_GE(std::count(single.begin(), single.end(), '\n'), 3 + a.getHeight());
+    size_t lineStart = 0;
+    while(lineStart < single.size()){
+        size_t lineEnd = single.find('\n', lineStart);
+        EXPECT_LE(lineEnd - lineStart, 70);
+        lineStart = lineEnd + 1;
+    }
+}
+
+TEST(FloatImageTests, PFMKeepsUnclampedFloats){
+    Canvas a(2, 2);
+    a.write_pixel(0, 0, Colour(2.5, -0.5, 0.25));
+    a.write_pixel(1, 1, Colour(0, 10, 1));
+
+    std::ostringstream out;
+    a.writePFM(out);
+    std::string file = out.str();
+
+    std::string header = "PF\n2 2\n-1.0\n";
+    ASSERT_EQ(file.substr(0, header.size()), header);
+    ASSERT_EQ(file.size(), header.size() + 4*3*sizeof(float));
+
+    // Rows are stored bottom to top
+    float pixels[12];
+    std::memcpy(pixels, file.data() + header.size(), sizeof(pixels));
+    EXPECT_FLOAT_EQ(pixels[3], 0);
+    EXPECT_FLOAT_EQ(pixels[4], 10);
+    EXPECT_FLOAT_EQ(pixels[5], 1);
+    EXPECT_FLOAT_EQ(pixels[6], 2.5);
+    EXPECT_FLOAT_EQ(pixels[7], -0.5);
+    EXPECT_FLOAT_EQ(pixels[8], 0.25);
+}
+
+TEST(FloatImageTests, RGBEKeepsValuesAboveOne){
+    unsigned char rgbe[4];
+
+    colourToRGBE(Colour(0, 0, 0), rgbe);
+    EXPECT_EQ(rgbe[3], 0);
+
+    colourToRGBE(Colour(4, 1, 0.5), rgbe);
+    float scale = ldexp(1.0, rgbe[3] - (128 + 8));
+    EXPECT_NEAR(rgbe[0]*scale, 4, 0.02);
+    EXPECT_NEAR(rgbe[1]*scale, 1, 0.02);
+    EXPECT_NEAR(rgbe[2]*scale, 0.5, 0.02);
+}
+
+// Decodes one run length encoded component of n bytes, returns the number of encoded bytes read
+static int decodeRGBERun(const unsigned char* in, int n, unsigned char* out){
+    const unsigned char* p = in;
+    int x = 0;
+    while(x < n){
+        int count = *p++;
+        if(count > 128){
+            count -= 128;
+            std::memset(out + x, *p++, count);
+        }else{
+            std::memcpy(out + x, p, count);
+            p += count;
+        }
+        x += count;
+    }
+    EXPECT_EQ(x, n);
+    return p - in;
+}
+
+TEST(FloatImageTests, RGBERunLengthEncodingRoundTrips){
+    std::vector<unsigned char> data;
+    for(int i = 0; i < 300; i++){
+        // Mix of long runs, short runs and literal bytes
+        data.push_back(i < 150 ? 7 : (i % 5 < 2 ? 9 : i % 251));
+    }
+    std::vector<unsigned char> encoded(data.size() + (data.size() + 127)/128);
+    std::vector<unsigned char> decoded(data.size());
+
+    int length = encodeRGBERun(data.data(), data.size(), encoded.data());
+
+    EXPECT_LT(length, data.size());
+    EXPECT_EQ(decodeRGBERun(encoded.data(), data.size(), decoded.data()), length);
+    EXPECT_EQ(decoded, data);
+}
+
+TEST(FloatImageTests, HDRScanlinesDecodeToCanvas){
+    Canvas a(20, 3);
+    for(int y = 0; y < a.getHeight(); y++){
+        for(int x = 0; x < a.getWidth(); x++){
+            a.write_pixel(x, y, x < 10 ? Colour(3, 2, 1) : Colour(0.1*x, 0.5, y));
+        }
+    }
+
+    std::ostringstream out;
+    a.writeHDR(out);
+    std::string file = out.str();
+
+    std::string header = "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y 3 +X 20\n";
+    ASSERT_EQ(file.substr(0, header.size()), header);
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(file.data()) + header.size();
+    for(int y = 0; y < a.getHeight(); y++){
+        EXPECT_EQ(p[0], 2);
+        EXPECT_EQ(p[1], 2);
+        EXPECT_EQ(p[2]*256 + p[3], 20);
+        p += 4;
+
+        unsigned char components[4][20];
+        for(int c = 0; c < 4; c++){
+            p += decodeRGBERun(p, 20, components[c]);
+        }
+        for(int x = 0; x < a.getWidth(); x++){
+            unsigned char expected[4];
+            colourToRGBE(a.pixelColour(x, y), expected);
+            for(int c = 0; c < 4; c++){
+                EXPECT_EQ(components[c][x], expected[c]);
+            }
+        }
+    }
+    EXPECT_EQ(p, reinterpret_cast<const unsigned char*>(file.data()) + file.size());
+}
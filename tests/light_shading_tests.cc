@@ -216,10 +216,28 @@ TEST(LightDataTest, OverpointTest){
 
 TEST(LightDataTest, ReflectVectorTest){
     Plane* p = new Plane;
+    Material m;
+    m.reflective = 0.5;
+    p->setMaterial(m);
     Ray r(Point(0, 1, -1), Vector(0, -sqrt(2)/2, sqrt(2)/2));
     Intersection i(sqrt(2), p);
     LightData data = prepareLightData(i, r);
     EXPECT_TRUE(data.reflect.isEqual(Vector(0, sqrt(2)/2, sqrt(2)/2)));
+    delete p;
+}
+
+// Opaque, non reflective hits skip the reflection and refraction fields
+TEST(LightDataTest, OpaqueHitSkipsSecondaryFields){
+    Sphere* s = new Sphere;
+    Ray r(Point(0, 0, -5), Vector(0, 0, 1));
+    std::vector<Intersection> intersects({Intersection(4, s), Intersection(6, s)});
+    LightData data = prepareLightData(intersects.at(0), r, intersects);
+    EXPECT_TRUE(data.reflect.isEqual(Vector()));
+    EXPECT_TRUE(data.underPoint.isEqual(Point()));
+    EXPECT_EQ(data.n1, 1.0);
+    EXPECT_EQ(data.n2, 1.0);
+    EXPECT_TRUE(data.overPoint.isEqual(Point(0, 0, -1 - EPSILON)));
+    delete s;
 }
 
 TEST(FindRefractiveIndicesTest, RayPassesFromNothingToObject){
@@ -294,6 +312,71 @@ TEST(FindRefractiveIndicesTest, RayPassesFromObjectToNothing){
     EXPECT_EQ(data.n2, 1.0);
 }
 
+// Eight nested spheres with indices 1.1 to 1.8, the ray enters every sphere then exits them in reverse order
+TEST(FindRefractiveIndicesTest, NestedObjects){
+    std::vector<Sphere*> spheres;
+    std::vector<Intersection> RayIntersects;
+    for(int a = 0; a < 8; a++){
+        Material m;
+        m.refractiveIndex = 1.1 + 0.1*a;
+        spheres.push_back(glassSphere());
+        spheres.back()->setMaterial(m);
+        RayIntersects.push_back(Intersection(a, spheres.back()));
+    }
+    for(int a = 7; a >= 0; a--){
+        RayIntersects.push_back(Intersection(15 - a, spheres.at(a)));
+    }
+
+    LightData entering;
+    LightData exiting;
+    findRefractiveIndices(entering, RayIntersects.at(5), RayIntersects);
+    findRefractiveIndices(exiting, RayIntersects.at(10), RayIntersects);
+
+    EXPECT_FLOAT_EQ(entering.n1, 1.5);
+    EXPECT_FLOAT_EQ(entering.n2, 1.6);
+    EXPECT_FLOAT_EQ(exiting.n1, 1.6);
+    EXPECT_FLOAT_EQ(exiting.n2, 1.5);
+    for(int a = 0; a < spheres.size(); a++){
+        delete spheres.at(a);
+    }
+}
+
+// Overlapping objects are left out of order, the object left first is below the top of the stack
+TEST(FindRefractiveIndicesTest, ObjectsLeftOutOfOrder){
+    std::vector<Sphere*> spheres;
+    for(int a = 0; a < 3; a++){
+        Material m;
+        m.refractiveIndex = 1.5 + 0.5*a;
+        spheres.push_back(glassSphere());
+        spheres.back()->setMaterial(m);
+    }
+    Sphere* A = spheres.at(0);
+    Sphere* B = spheres.at(1);
+    Sphere* C = spheres.at(2);
+    std::vector<Intersection> RayIntersects({Intersection(0, A), Intersection(1, B), Intersection(2, C), Intersection(3, A), Intersection(4, C), Intersection(5, A), Intersection(6, A), Intersection(7, B)});
+
+    LightData leavingA;
+    LightData leavingC;
+    LightData reenteringA;
+    LightData leavingB;
+    findRefractiveIndices(leavingA, RayIntersects.at(3), RayIntersects);
+    findRefractiveIndices(leavingC, RayIntersects.at(4), RayIntersects);
+    findRefractiveIndices(reenteringA, RayIntersects.at(5), RayIntersects);
+    findRefractiveIndices(leavingB, RayIntersects.at(7), RayIntersects);
+
+    EXPECT_FLOAT_EQ(leavingA.n1, 2.5);
+    EXPECT_FLOAT_EQ(leavingA.n2, 2.5);
+    EXPECT_FLOAT_EQ(leavingC.n1, 2.5);
+    EXPECT_FLOAT_EQ(leavingC.n2, 2);
+    EXPECT_FLOAT_EQ(reenteringA.n1, 2);
+    EXPECT_FLOAT_EQ(reenteringA.n2, 1.5);
+    EXPECT_FLOAT_EQ(leavingB.n1, 2);
+    EXPECT_FLOAT_EQ(leavingB.n2, 1);
+    for(int a = 0; a < spheres.size(); a++){
+        delete spheres.at(a);
+    }
+}
+
 // Test for the underPoint variable in the LightData 
 // Checks that it is a little bit below the object surface
 TEST(LightDataTest, UnderpointTest){
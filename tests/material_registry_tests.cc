@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include "MaterialRegistry.h"
+#include "Shape.h"
+#include "LightAndShading.h"
+#include "ThreadPool.h"
+#include <stdexcept>
+
+TEST(MaterialRegistryTest, StartsWithDefaultMaterial){
+    MaterialRegistry registry;
+    EXPECT_EQ(registry.size(), 1);
+    EXPECT_TRUE(registry.contains(DEFAULT_MATERIAL));
+    EXPECT_TRUE(registry.get(DEFAULT_MATERIAL).isEqual(Material()));
+    EXPECT_THROW(registry.release(DEFAULT_MATERIAL), std::invalid_argument);
+}
+
+TEST(MaterialRegistryTest, AddSetAndRelease){
+    MaterialRegistry registry;
+    Material m;
+    m.reflective = 0.5;
+    MaterialID id = registry.add(m);
+    EXPECT_EQ(registry.size(), 2);
+    EXPECT_TRUE(registry.get(id).isEqual(m));
+
+    m.transparency = 0.25;
+    registry.set(id, m);
+    EXPECT_EQ(registry.get(id).transparency, 0.25f);
+
+    // Released IDs are reused before the table grows
+    registry.release(id);
+    EXPECT_EQ(registry.size(), 1);
+    EXPECT_FALSE(registry.contains(id));
+    EXPECT_THROW(registry.set(id, m), std::invalid_argument);
+    EXPECT_THROW(registry.release(id), std::invalid_argument);
+    EXPECT_EQ(registry.add(Material()), id);
+    EXPECT_THROW(registry.set(100, m), std::invalid_argument);
+}
+
+TEST(Shape_setMaterialIDTest, EditsApplyToEveryShapeUsingTheMaterial){
+    Material m;
+    m.colour = Colour(1, 0, 0);
+    MaterialID red = materialRegistry().add(m);
+
+    std::vector<Sphere> spheres(100);
+    for(int i = 0; i < spheres.size(); i++){
+        spheres.at(i).setMaterialID(red);
+    }
+    int size = materialRegistry().size();
+
+    m.colour = Colour(0, 0, 1);
+    materialRegistry().set(red, m);
+    for(int i = 0; i < spheres.size(); i++){
+        EXPECT_EQ(spheres.at(i).getMaterialID(), red);
+        EXPECT_TRUE(spheres.at(i).getMaterial().colour.isEqual(Colour(0, 0, 1)));
+    }
+    EXPECT_EQ(materialRegistry().size(), size);
+    EXPECT_THROW(spheres.at(0).setMaterialID(-1), std::invalid_argument);
+
+    for(int i = 0; i < spheres.size(); i++){
+        spheres.at(i).setMaterialID(DEFAULT_MATERIAL);
+    }
+    materialRegistry().release(red);
+}
+
+TEST(Shape_setMaterialTest, OwnMaterialIsReusedAndReleased){
+    int size = materialRegistry().size();
+    Sphere* s = new Sphere;
+    EXPECT_EQ(s->getMaterialID(), DEFAULT_MATERIAL);
+
+    Material m;
+    m.ambient = 0.4;
+    s->setMaterial(m);
+    MaterialID id = s->getMaterialID();
+    m.ambient = 0.6;
+    s->setMaterial(m);
+    EXPECT_EQ(s->getMaterialID(), id);
+    EXPECT_EQ(s->getMaterial().ambient, 0.6f);
+    EXPECT_EQ(materialRegistry().size(), size + 1);
+
+    // A copy gets its own material, so changing it doesn't change the original
+    Sphere copy = *s;
+    EXPECT_NE(copy.getMaterialID(), id);
+    m.ambient = 0.2;
+    copy.setMaterial(m);
+    EXPECT_EQ(s->getMaterial().ambient, 0.6f);
+
+    delete s;
+    EXPECT_FALSE(materialRegistry().contains(id));
+}
+
+// A material a shape added for itself can't be released by other code, so its ID is never handed to
+// another shape while the shape uses it
+TEST(Shape_setMaterialTest, OwnMaterialCantBeReleasedElsewhere){
+    Sphere* a = new Sphere;
+    Material m;
+    m.ambient = 0.9;
+    a->setMaterial(m);
+    MaterialID id = a->getMaterialID();
+    EXPECT_THROW(materialRegistry().release(id), std::invalid_argument);
+    EXPECT_FALSE(materialRegistry().contains(id));
+    EXPECT_THROW(Sphere().setMaterialID(id), std::invalid_argument);
+
+    Sphere b;
+    b.setMaterial(Material());
+    EXPECT_NE(b.getMaterialID(), id);
+    EXPECT_EQ(a->getMaterial().ambient, 0.9f);
+
+    // Deleting a frees only its own material
+    MaterialID bID = b.getMaterialID();
+    m.ambient = 0.3;
+    b.setMaterial(m);
+    delete a;
+    EXPECT_EQ(b.getMaterialID(), bID);
+    EXPECT_EQ(b.getMaterial().ambient, 0.3f);
+    Sphere c;
+    c.setMaterial(Material());
+    EXPECT_NE(c.getMaterialID(), bID);
+    EXPECT_EQ(b.getMaterial().ambient, 0.3f);
+}
+
+// Releasing a registered material only drops its registration, shapes using it keep it until they stop
+TEST(Shape_setMaterialIDTest, ReleasedMaterialIsKeptWhileShapesUseIt){
+    int size = materialRegistry().size();
+    Material m;
+    m.colour = Colour(1, 0, 0);
+    MaterialID red = materialRegistry().add(m);
+    Sphere* s = new Sphere;
+    s->setMaterialID(red);
+    Sphere copy = *s;
+
+    materialRegistry().release(red);
+    EXPECT_FALSE(materialRegistry().contains(red));
+    EXPECT_THROW(materialRegistry().release(red), std::invalid_argument);
+    EXPECT_THROW(Sphere().setMaterialID(red), std::invalid_argument);
+    MaterialID other = materialRegistry().add(Material());
+    EXPECT_NE(other, red);
+    EXPECT_TRUE(s->getMaterial().colour.isEqual(Colour(1, 0, 0)));
+
+    delete s;
+    EXPECT_TRUE(copy.getMaterial().colour.isEqual(Colour(1, 0, 0)));
+    copy.setMaterialID(DEFAULT_MATERIAL);
+    EXPECT_EQ(materialRegistry().size(), size + 1);
+    materialRegistry().release(other);
+    EXPECT_EQ(materialRegistry().size(), size);
+}
+
+// Shapes with their own materials are created, copied and destroyed on several threads at once
+TEST(Shape_setMaterialTest, ConcurrentCopiesAndDestruction){
+    int size = materialRegistry().size();
+    Sphere original;
+    Material m;
+    m.reflective = 0.5;
+    original.setMaterial(m);
+
+    ThreadPool pool(8);
+    pool.parallelFor(64, [&](int i){
+        for(int j = 0; j < 50; j++){
+            Sphere copy = original;
+            Sphere other;
+            Material own;
+            own.ambient = i*0.01;
+            other.setMaterial(own);
+            other = copy;
+            // Other threads add and release materials, so the materials are read with copy rather than get
+            Material expected = materialRegistry().copy(original.getMaterialID());
+            if(copy.getMaterialID() == original.getMaterialID() || !materialRegistry().copy(other.getMaterialID()).isEqual(expected)){
+                throw std::runtime_error("Shape copy shares or lost its material");
+            }
+        }
+    });
+    EXPECT_EQ(materialRegistry().size(), size + 1);
+}
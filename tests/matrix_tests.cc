@@ -269,4 +269,77 @@ TEST(MatrixTransformations, ChainingTest){
     Matrix transform = chainTransformationMatrices({A, B, C});
     EXPECT_TRUE((transform*p).isEqual(p4));
     EXPECT_TRUE(transform.isEqual((C*B*A)));
-}
\ No newline at end of file
+}
+
+TEST(Matrix4Tests, DefaultIsIdentity){
+    Matrix4 a;
+    EXPECT_TRUE(Matrix(a).isEqual(Matrix(4)));
+    EXPECT_TRUE(a.isEqual(Matrix(4)));
+}
+
+TEST(Matrix4Tests, ConversionFromMatrix){
+    std::vector<std::vector<float>> v1 = {{1, 2, 3, 4}, {5.5, 6.5, 7.5, 8.5}, {9, 10, 11, 12}, {13.5, 14.5, 15.5, 16.5}};
+    Matrix4 a = Matrix(4, 4, v1);
+    EXPECT_TRUE(floatIsEqual(a.getElement(0, 3), 4));
+    EXPECT_TRUE(floatIsEqual(a.getElement(1, 0), 5.5));
+    EXPECT_TRUE(floatIsEqual(a.getElement(3, 2), 15.5));
+    EXPECT_THROW(a.getElement(4, 0), std::invalid_argument);
+
+    // Only 4x4 matrices can be converted
+    EXPECT_THROW(Matrix4(Matrix(3)), std::invalid_argument);
+}
+
+TEST(Matrix4Tests, MultiplicationMatchesMatrix){
+    std::vector<std::vector<float>> v1 = {{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 8, 7, 6}, {5, 4, 3, 2}};
+    std::vector<std::vector<float>> v2 = {{-2, 1, 2, 3}, {3, 2, 1, -1}, {4, 3, 6, 5}, {1, 2, 7, 8}};
+    Matrix4 a = Matrix(4, 4, v1);
+    Matrix4 b = Matrix(4, 4, v2);
+
+    std::vector<std::vector<float>> v3 = {{20, 22, 50, 48}, {44, 54, 114, 108}, {40, 58, 110, 102}, {16, 26, 46, 42}};
+    EXPECT_TRUE((a*b).isEqual(Matrix(4, 4, v3)));
+    EXPECT_TRUE((a*Tuple(1, 2, 3, 1)).isEqual(Tuple(18, 46, 52, 24)));
+}
+
+TEST(Matrix4Tests, TransposeAndInverse){
+    std::vector<std::vector<float>> v1 = {{0, 9, 3, 0}, {9, 8, 0, 8}, {1, 8, 5, 3}, {0, 0, 5, 8}};
+    std::vector<std::vector<float>> v2 = {{0, 9, 1, 0}, {9, 8, 8, 0}, {3, 0, 5, 5}, {0, 8, 3, 8}};
+    Matrix4 a = Matrix(4, 4, v1);
+    EXPECT_TRUE(a.transpose().isEqual(Matrix(4, 4, v2)));
+
+    std::vector<std::vector<float>> v3 = {{-5, 2, 6, -8}, {1, -5, 1, 8}, {7, 7, -6, -7}, {1, -3, 7, 4}};
+    std::vector<std::vector<float>> v4 = {{0.21805, 0.45113, 0.24060, -0.04511}, {-0.80827, -1.45677, -0.44361, 0.52068}, {-0.07895, -0.22368, -0.05263, 0.19737}, {-0.52256, -0.81391, -0.30075, 0.30639}};
+    Matrix4 c = Matrix(4, 4, v3);
+    EXPECT_TRUE(floatIsEqual(c.determinant(), 532));
+    EXPECT_TRUE(c.inverse().isEqual(Matrix(4, 4, v4)));
+}
+
+TEST(Matrix4Tests, ClosedFormInverseMatchesCofactorInverse){
+    std::vector<std::vector<float>> v1 = {{8, -5, 9, 2}, {7, 5, 6, 1}, {-6, 0, 9, 6}, {-3, 0, -9, -4}};
+    std::vector<std::vector<float>> v2 = {{9, 3, 0, 9}, {-5, -2, -6, -3}, {-4, 9, 6, 4}, {-7, 6, 6, 2}};
+    Matrix a(4, 4, v1);
+    Matrix b(4, 4, v2);
+
+    EXPECT_FALSE(Matrix4(a).isAffine());
+    EXPECT_TRUE(floatIsEqual(Matrix4(a).determinant(), a.determinant()));
+    EXPECT_TRUE(floatIsEqual(Matrix4(b).determinant(), b.determinant()));
+    EXPECT_TRUE(Matrix4(a).inverse().isEqual(a.inverse()));
+    EXPECT_TRUE(Matrix4(b).inverse().isEqual(b.inverse()));
+
+    std::vector<std::vector<float>> v3 = {{-4, 2, -2, -3}, {9, 6, 2, 6}, {0, -5, 1, -5}, {0, 0, 0, 0}};
+    Matrix4 c = Matrix(4, 4, v3);
+    EXPECT_FALSE(c.isInvertable());
+    EXPECT_THROW(c.inverse(), std::invalid_argument);
+}
+
+TEST(Matrix4Tests, AffineInverseMatchesCofactorInverse){
+    Matrix4 a = chainTransformationMatrices({xRotationMatrix(PI/3), shearingMatrix(1, 0.5, 0, 0.25, 0, 2), scalingMatrix(2, -3, 0.5), translationMatrix(10, -5, 7)});
+    EXPECT_TRUE(a.isAffine());
+    EXPECT_TRUE(a.inverseAffine().isEqual(Matrix(a).inverse()));
+    EXPECT_TRUE(a.inverse().isEqual(Matrix(a).inverse()));
+    EXPECT_TRUE((a*a.inverse()).isEqual(Matrix4()));
+
+    // The affine path only applies to matrices with a bottom row of 0, 0, 0, 1
+    std::vector<std::vector<float>> v1 = {{6, 4, 4, 4}, {5, 5, 7, 6}, {4, -9, 3, -7}, {9, 1, 7, -6}};
+    EXPECT_THROW(Matrix4(Matrix(4, 4, v1)).inverseAffine(), std::invalid_argument);
+    EXPECT_THROW(scalingMatrix(0, 1, 1).inverse(), std::invalid_argument);
+}
@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+#include "ObjParser.h"
+#include "Triangle.h"
+#include "Group.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Text spanning several chunks, with groups that start and end inside chunks, polygons and relative indices
+// that refer back across chunk boundaries
+static std::string largeObj(){
+    std::ostringstream out;
+    int vertices = 0;
+    for(int i = 0; i < 12000; i++){
+        if(i % 700 == 0){
+            out << "g group" << (i/700) % 3 << "\n";
+        }
+        out << "v " << i*0.25 << " " << -i*0.5 << " " << i % 17 << "\n";
+        out << "vn 0 " << i % 2 << " 1\n";
+        vertices++;
+        if(vertices >= 4){
+            if(i % 3 == 0){
+                out << "f -1 -2 -3 -4\n";
+            }else{
+                out << "f " << vertices - 2 << "/1/1 " << vertices - 1 << "//1 " << vertices << "\n";
+            }
+        }
+        if(i % 50 == 0){
+            out << "# comment line\n";
+        }
+    }
+    return out.str();
+}
+
+TEST(ObjParserTest, IgnoresUnrecognizedLines){
+    ObjParser parser("There was a young lady named Bright\nwho traveled much faster than light.\n"
+        "She set out one day\nin a relative way,\nand came back the previous night.\n");
+    EXPECT_EQ(parser.getIgnoredLines(), 5);
+    EXPECT_EQ(parser.getVertices().size(), 0);
+}
+
+TEST(ObjParserTest, VertexRecords){
+    ObjParser parser("v -1 1 0\nv -1.0000 0.5000 0.0000\r\nv 1 0 0\n  v\t1 1 0");
+    const std::vector<Point> &v = parser.getVertices();
+    ASSERT_EQ(v.size(), 4);
+    EXPECT_TRUE(v.at(0).isEqual(Point(-1, 1, 0)));
+    EXPECT_TRUE(v.at(1).isEqual(Point(-1, 0.5, 0)));
+    EXPECT_TRUE(v.at(2).isEqual(Point(1, 0, 0)));
+    EXPECT_TRUE(v.at(3).isEqual(Point(1, 1, 0)));
+}
+
+TEST(ObjParserTest, VertexNormalRecords){
+    ObjParser parser("vn 0 0 1\nvn 0.707 0 -0.707\nvn 1 2 3\n");
+    const std::vector<Vector> &n = parser.getNormals();
+    ASSERT_EQ(n.size(), 3);
+    EXPECT_TRUE(n.at(0).isEqual(Vector(0, 0, 1)));
+    EXPECT_TRUE(n.at(1).isEqual(Vector(0.707, 0, -0.707)));
+    EXPECT_TRUE(n.at(2).isEqual(Vector(1, 2, 3)));
+}
+
+TEST(ObjParserTest, TriangleFaces){
+    ObjParser parser("v -1 1 0\nv -1 0 0\nv 1 0 0\nv 1 1 0\n\nf 1 2 3\nf 1 3 4\n");
+    ASSERT_EQ(parser.getGroups().size(), 1);
+    EXPECT_EQ(parser.getGroups().at(0).name, "");
+    EXPECT_EQ(parser.getGroups().at(0).indices, std::vector<uint32_t>({0, 1, 2, 0, 2, 3}));
+}
+
+TEST(ObjParserTest, PolygonsAreTriangulated){
+    ObjParser parser("v -1 1 0\nv -1 0 0\nv 1 0 0\nv 1 1 0\nv 0 2 0\nf 1 2 3 4 5\n");
+    EXPECT_EQ(parser.getGroups().at(0).indices, std::vector<uint32_t>({0, 1, 2, 0, 2, 3, 0, 3, 4}));
+}
+
+TEST(ObjParserTest, FacesWithTextureAndNormalIndices){
+    ObjParser parser("v 0 1 0\nv -1 0 0\nv 1 0 0\nvn -1 0 0\nvn 1 0 0\nvn 0 1 0\nf 1//3 2//1 3//2\nf 1/0/3 2/102/1 3/14/2\nf 1/1 2/2 3/3\n");
+    EXPECT_EQ(parser.getGroups().at(0).indices, std::vector<uint32_t>({0, 1, 2, 0, 1, 2, 0, 1, 2}));
+    EXPECT_EQ(parser.getNormals().size(), 3);
+}
+
+TEST(ObjParserTest, NegativeIndicesCountBackFromLastVertex){
+    ObjParser parser("v 0 1 0\nv -1 0 0\nv 1 0 0\nf -3 -2 -1\nv 1 1 0\nf 1 -2 -1\n");
+    EXPECT_EQ(parser.getGroups().at(0).indices, std::vector<uint32_t>({0, 1, 2, 0, 2, 3}));
+}
+
+TEST(ObjParserTest, TrianglesInGroups){
+    ObjParser parser("v -1 1 0\nv -1 0 0\nv 1 0 0\nv 1 1 0\ng FirstGroup\nf 1 2 3\ng SecondGroup\nf 1 3 4\ng FirstGroup\nf 2 3 4\n");
+    const std::vector<ObjGroup> &groups = parser.getGroups();
+    ASSERT_EQ(groups.size(), 3);
+    EXPECT_TRUE(groups.at(0).indices.empty());
+    EXPECT_EQ(groups.at(1).name, "FirstGroup");
+    EXPECT_EQ(groups.at(1).indices, std::vector<uint32_t>({0, 1, 2, 1, 2, 3}));
+    EXPECT_EQ(groups.at(2).name, "SecondGroup");
+    EXPECT_EQ(groups.at(2).indices, std::vector<uint32_t>({0, 2, 3}));
+}
+
+TEST(ObjParserTest, InvalidRecordsThrow){
+    EXPECT_THROW(ObjParser("v 1 2\n"), std::invalid_argument);
+    EXPECT_THROW(ObjParser("vn 1 x 2\n"), std::invalid_argument);
+    EXPECT_THROW(ObjParser("v 0 0 0\nv 1 0 0\nf 1 2\n"), std::invalid_argument);
+    EXPECT_THROW(ObjParser("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 0 1 2\n"), std::invalid_argument);
+    EXPECT_THROW(ObjParser("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n"), std::invalid_argument);
+    EXPECT_THROW(ObjParser("v 0 0 0\nv 1 0 0\nv 0 1 0\nf -1 -2 -4\n"), std::invalid_argument);
+    EXPECT_THROW(ObjParser("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2a 3\n"), std::invalid_argument);
+}
+
+// Splitting the text into chunks parsed by several threads gives the same result as parsing it in one chunk
+TEST(ObjParserTest, ParallelParseMatchesSingleThread){
+    std::string text = largeObj();
+    ASSERT_GT(text.size(), 4*ObjParser::MIN_CHUNK_SIZE);
+    ObjParser single(text, 1);
+    ObjParser parallel(text, 4);
+
+    ASSERT_EQ(single.getVertices().size(), 12000);
+    ASSERT_EQ(parallel.getVertices().size(), single.getVertices().size());
+    for(int i = 0; i < single.getVertices().size(); i++){
+        EXPECT_TRUE(parallel.getVertices().at(i).isEqual(single.getVertices().at(i)));
+    }
+    ASSERT_EQ(parallel.getNormals().size(), 12000);
+    EXPECT_TRUE(parallel.getNormals().at(11999).isEqual(Vector(0, 1, 1)));
+    EXPECT_EQ(parallel.getIgnoredLines(), single.getIgnoredLines());
+    EXPECT_EQ(parallel.getIgnoredLines(), 240);
+
+    ASSERT_EQ(single.getGroups().size(), 4);
+    ASSERT_EQ(parallel.getGroups().size(), single.getGroups().size());
+    for(int g = 0; g < single.getGroups().size(); g++){
+        EXPECT_EQ(parallel.getGroups().at(g).name, single.getGroups().at(g).name);
+        EXPECT_EQ(parallel.getGroups().at(g).indices, single.getGroups().at(g).indices);
+    }
+}
+
+TEST(ObjParser_toModelTest, NamedGroupsBecomeGroups){
+    ObjParser parser("v -1 1 0\nv -1 0 0\nv 1 0 0\nv 1 1 0\nv 5 5 5\nf 1 2 3\ng FirstGroup\nf 1 3 4\ng SecondGroup\nf 2 3 4 5\ng Empty\n");
+    ObjModel model = parser.toModel();
+    Group* g = model.getRoot();
+    ASSERT_EQ(g->getShapes().size(), 4);
+    EXPECT_TRUE(parser.getGroups().empty());
+
+    TriangleMesh* defaultMesh = dynamic_cast<TriangleMesh*>(g->getShapes().at(0));
+    ASSERT_NE(defaultMesh, nullptr);
+    EXPECT_EQ(defaultMesh->getTriangleCount(), 1);
+
+    Group* first = dynamic_cast<Group*>(g->getShapes().at(1));
+    ASSERT_NE(first, nullptr);
+    ASSERT_EQ(first->getShapes().size(), 1);
+    TriangleMesh* firstMesh = dynamic_cast<TriangleMesh*>(first->getShapes().at(0));
+    ASSERT_NE(firstMesh, nullptr);
+    // Each mesh only holds the vertices its faces use
+    ASSERT_EQ(firstMesh->getVertices().size(), 3);
+    EXPECT_EQ(firstMesh->getIndices(), std::vector<uint32_t>({0, 1, 2}));
+    EXPECT_TRUE(firstMesh->getVertices().at(2).isEqual(Point(1, 1, 0)));
+    EXPECT_EQ(firstMesh->getParent(), first);
+
+    Group* second = dynamic_cast<Group*>(g->getShapes().at(2));
+    ASSERT_NE(second, nullptr);
+    TriangleMesh* secondMesh = dynamic_cast<TriangleMesh*>(second->getShapes().at(0));
+    ASSERT_NE(secondMesh, nullptr);
+    EXPECT_EQ(secondMesh->getTriangleCount(), 2);
+    EXPECT_EQ(secondMesh->getVertices().size(), 4);
+
+    Group* empty = dynamic_cast<Group*>(g->getShapes().at(3));
+    ASSERT_NE(empty, nullptr);
+    EXPECT_TRUE(empty->getShapes().empty());
+}
+
+TEST(ObjParser_toModelTest, SingleGroupKeepsWholeVertexBuffer){
+    ObjParser parser("v -1 1 0\nv -1 0 0\nv 1 0 0\nv 1 1 0\nv 9 9 9\ng Only\nf 1 2 3\nf 1 3 4\n");
+    ObjModel model = parser.toModel();
+    Group* g = model.getRoot();
+    ASSERT_EQ(g->getShapes().size(), 1);
+    Group* only = dynamic_cast<Group*>(g->getShapes().at(0));
+    ASSERT_NE(only, nullptr);
+    TriangleMesh* mesh = dynamic_cast<TriangleMesh*>(only->getShapes().at(0));
+    ASSERT_NE(mesh, nullptr);
+    EXPECT_EQ(mesh->getVertices().size(), 5);
+    EXPECT_EQ(mesh->getIndices(), std::vector<uint32_t>({0, 1, 2, 0, 2, 3}));
+
+    // Moving the model keeps the shapes it owns where they are
+    ObjModel moved = std::move(model);
+    EXPECT_EQ(moved.getRoot(), g);
+    EXPECT_EQ(moved.getRoot()->getShapes().at(0), only);
+}
+
+TEST(parseObjFileTest, ParsesMappedFile){
+    std::string path = testing::TempDir() + "obj_parser_test.obj";
+    std::string text = largeObj();
+    {
+        std::ofstream f(path, std::ios::binary);
+        f << text;
+    }
+    ObjParser fromFile = parseObjFile(path, 4);
+    ObjParser fromText(text, 1);
+    EXPECT_EQ(fromFile.getVertices().size(), fromText.getVertices().size());
+    ASSERT_EQ(fromFile.getGroups().size(), fromText.getGroups().size());
+    for(int g = 0; g < fromText.getGroups().size(); g++){
+        EXPECT_EQ(fromFile.getGroups().at(g).indices, fromText.getGroups().at(g).indices);
+    }
+
+    // An empty file has nothing to map
+    {
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    }
+    EXPECT_EQ(parseObjFile(path).getVertices().size(), 0);
+    std::remove(path.c_str());
+
+    EXPECT_THROW(parseObjFile(testing::TempDir() + "missing_file.obj"), std::invalid_argument);
+}
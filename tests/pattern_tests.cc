@@ -27,6 +27,18 @@ TEST(PatternTest, SetTransform_SetCorrectly){
     EXPECT_TRUE(p.getTransform().isEqual(translationMatrix(1, 2, 3)));
 }
 
+TEST(PatternTest, SetTransform_InverseUpdated){
+    // Arrange
+    Pattern p;
+
+    // Act
+    p.setTransform(translationMatrix(1, 2, 3));
+    p.setTransform(scalingMatrix(2, 4, 8));
+
+    // Assert
+    EXPECT_TRUE(p.getInverseTransform().isEqual(scalingMatrix(0.5, 0.25, 0.125)));
+}
+
 TEST(PatternTest, ApplyPattern_ObjectTransformationAppliedCorrectly){
     // Arrange
     Sphere* s = new Sphere;
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include "PrimitiveStore.h"
+#include "Shape.h"
+#include "Group.h"
+#include "Triangle.h"
+#include "BVH.h"
+#include "World.h"
+#include "common.h"
+#include <algorithm>
+
+// Shape with its own intersection code, must not be stored as the built in type it derives from
+class OffsetSphere : public Sphere{
+public:
+    using Shape::childIntersections;
+    void childIntersections(const Ray &r, std::vector<Intersection> &intersects){
+        intersects.push_back(Intersection(42, this));
+    }
+};
+
+TEST(PrimitiveStore_typeOfTest, ExactTypesAreStoredByValue){
+    Sphere s;
+    Plane p;
+    Cube c;
+    Cylinder cyl;
+    Cone cone;
+    Triangle t(Point(0, 1, 0), Point(-1, 0, 0), Point(1, 0, 0));
+    TriangleMesh mesh({Point(0, 1, 0), Point(-1, 0, 0), Point(1, 0, 0)}, {0, 1, 2});
+    Group g;
+    OffsetSphere o;
+
+    EXPECT_EQ(PrimitiveStore::typeOf(&s), PRIMITIVE_SPHERE);
+    EXPECT_EQ(PrimitiveStore::typeOf(&p), PRIMITIVE_PLANE);
+    EXPECT_EQ(PrimitiveStore::typeOf(&c), PRIMITIVE_CUBE);
+    EXPECT_EQ(PrimitiveStore::typeOf(&cyl), PRIMITIVE_CYLINDER);
+    EXPECT_EQ(PrimitiveStore::typeOf(&cone), PRIMITIVE_CONE);
+    EXPECT_EQ(PrimitiveStore::typeOf(&t), PRIMITIVE_TRIANGLE);
+    EXPECT_EQ(PrimitiveStore::typeOf(&mesh), PRIMITIVE_SHAPE);
+    EXPECT_EQ(PrimitiveStore::typeOf(&g), PRIMITIVE_SHAPE);
+    EXPECT_EQ(PrimitiveStore::typeOf(&o), PRIMITIVE_SHAPE);
+}
+
+TEST(PrimitiveStore_addTest, PrimitivesAreGroupedByType){
+    Sphere s1, s2;
+    Cube c;
+    Cone cone;
+    PrimitiveStore store;
+    store.add(&s1);
+    store.add(&c);
+    store.add(&s2);
+    store.add(&cone);
+
+    EXPECT_EQ(store.size(), 4);
+    EXPECT_EQ(store.getType(2), PRIMITIVE_SPHERE);
+    EXPECT_EQ(store.count(PRIMITIVE_SPHERE), 2);
+    EXPECT_EQ(store.count(PRIMITIVE_CUBE), 1);
+    EXPECT_EQ(store.count(PRIMITIVE_CONE), 1);
+    EXPECT_EQ(store.count(PRIMITIVE_PLANE), 0);
+
+    store.clear();
+    EXPECT_EQ(store.size(), 0);
+    EXPECT_EQ(store.count(PRIMITIVE_SPHERE), 0);
+}
+
+// Every type of primitive inside a transformed group gives the same intersections as the shape itself
+TEST(PrimitiveStore_intersectTest, MatchesShapeIntersections){
+    Group* g = new Group;
+    g->setTransform(translationMatrix(0.2, -0.3, 1)*yRotationMatrix(PI/7));
+    std::vector<Shape*> shapes({new Sphere, new Plane, new Cube, new Cylinder, new Cone, new OffsetSphere,
+        new Triangle(Point(0, 1, 0), Point(-1, -0.5, 0.2), Point(1, -0.5, -0.2)),
+        new TriangleMesh({Point(0, 1, 0), Point(-1, -0.5, 0.2), Point(1, -0.5, -0.2), Point(0, -1, 0)}, {0, 1, 2, 1, 3, 2})});
+    for(int i = 0; i < shapes.size(); i++){
+        shapes.at(i)->setTransform(scalingMatrix(1, 1.5, 0.75)*xRotationMatrix(0.3*i));
+        g->appendShape(shapes.at(i));
+    }
+    Cylinder* cyl = static_cast<Cylinder*>(shapes.at(3));
+    cyl->setMinH(-1);
+    cyl->setMaxH(1);
+    cyl->setClosed(true);
+    Cone* cone = static_cast<Cone*>(shapes.at(4));
+    cone->setMinH(-1);
+    cone->setMaxH(0.5);
+    cone->setClosed(true);
+
+    std::vector<Shape*> primitives;
+    g->commitTransforms(Matrix4(), Matrix4(), primitives);
+    PrimitiveStore store;
+    for(int i = 0; i < primitives.size(); i++){
+        store.add(primitives.at(i));
+    }
+
+    std::vector<Ray> rays({Ray(Point(0, 0, -5), Vector(0, 0, 1)), Ray(Point(0.3, 2, -4), Vector(0, -0.4, 1).normalize()),
+        Ray(Point(-0.5, 0.1, -6), Vector(0.1, 0, 1).normalize())});
+    for(int i = 0; i < rays.size(); i++){
+        for(int j = 0; j < primitives.size(); j++){
+            std::vector<Intersection> expected;
+            primitives.at(j)->findWorldIntersections(rays.at(i), expected);
+            std::vector<Intersection> result;
+            store.intersect(j, rays.at(i), result);
+
+            ASSERT_EQ(result.size(), expected.size());
+            for(int k = 0; k < result.size(); k++){
+                EXPECT_TRUE(result.at(k).isEqual(expected.at(k)));
+            }
+
+            float expectedMax = INFINITY;
+            float resultMax = INFINITY;
+            Intersection expectedHit(INFINITY, nullptr);
+            Intersection resultHit(INFINITY, nullptr);
+            bool found = primitives.at(j)->closestWorldIntersection(rays.at(i), 0, expectedMax, expectedHit);
+            EXPECT_EQ(store.closestIntersection(j, rays.at(i), 0, resultMax, resultHit), found);
+            if(found){
+                EXPECT_TRUE(resultHit.isEqual(expectedHit));
+            }
+            EXPECT_EQ(store.occludes(j, rays.at(i), 0, INFINITY), primitives.at(j)->worldOccludes(rays.at(i), 0, INFINITY));
+        }
+    }
+
+    for(int i = 0; i < shapes.size(); i++){
+        delete shapes.at(i);
+    }
+    delete g;
+}
+
+// Shadow rays read the shape's current material, so new materials and edits are seen without rebuilding
+TEST(PrimitiveStore_occludesTest, UsesShapesCurrentMaterial){
+    Sphere s;
+    Material m;
+    m.castsShadow = false;
+    m.ambient = 0.3;
+    s.setMaterial(m);
+    PrimitiveStore store;
+    store.add(&s);
+    Ray r(Point(0, 0, -5), Vector(0, 0, 1));
+
+    EXPECT_EQ(store.getShape(0), &s);
+    EXPECT_EQ(store.getMaterialID(0), s.getMaterialID());
+    EXPECT_TRUE(store.getMaterial(0).isEqual(m));
+    EXPECT_FALSE(store.occludes(0, r, 0, INFINITY));
+
+    s.setMaterial(Material());
+    EXPECT_TRUE(store.occludes(0, r, 0, INFINITY));
+
+    // A different material ID is seen without rebuilding the store
+    MaterialID shared = materialRegistry().add(m);
+    s.setMaterialID(shared);
+    EXPECT_EQ(store.getMaterialID(0), shared);
+    EXPECT_FALSE(store.occludes(0, r, 0, INFINITY));
+    s.setMaterialID(DEFAULT_MATERIAL);
+    materialRegistry().release(shared);
+}
+
+// A group is intersected through its shapes, so the material of each hit shape is checked
+TEST(PrimitiveStore_occludesTest, GroupChecksEachHitShape){
+    Group g;
+    Sphere s;
+    Material m;
+    m.castsShadow = false;
+    s.setMaterial(m);
+    g.appendShape(&s);
+    PrimitiveStore store;
+    store.add(&g);
+    Ray r(Point(0, 0, -5), Vector(0, 0, 1));
+
+    EXPECT_FALSE(store.occludes(0, r, 0, INFINITY));
+    s.setMaterial(Material());
+    EXPECT_TRUE(store.occludes(0, r, 0, INFINITY));
+}
+
+TEST(BVH_getPrimitiveStoreTest, StoreFollowsLeafOrder){
+    World w = defaultWorld();
+    w.appendObject(new Plane);
+    w.appendObject(new Cube);
+    w.buildBVH();
+
+    BVH bvh(w.getPrimitives());
+    const PrimitiveStore &store = bvh.getPrimitiveStore();
+    ASSERT_EQ(store.size(), 4);
+    EXPECT_EQ(store.count(PRIMITIVE_SPHERE), 2);
+    EXPECT_EQ(store.count(PRIMITIVE_CUBE), 1);
+    // The unbounded plane comes after the bounded shapes
+    EXPECT_EQ(store.getType(3), PRIMITIVE_PLANE);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "RenderStats.h"
+#include "Camera.h"
+#include "World.h"
+#include <thread>
+
+TEST(RenderStats_addRenderStatTest, CountsAreCollected){
+    resetRenderStats();
+
+    addRenderStat(SHADOW_RAYS);
+    addRenderStat(SHADOW_RAYS, 4);
+    addRenderStat(SPHERE_HITS);
+
+    RenderStats stats = collectRenderStats();
+    EXPECT_EQ(stats.getCounter(SHADOW_RAYS), 5);
+    EXPECT_EQ(stats.getCounter(SPHERE_HITS), 1);
+    EXPECT_EQ(stats.getCounter(PRIMARY_RAYS), 0);
+}
+
+TEST(RenderStats_addRenderStatTest, CountsOfExitedThreadsAreKept){
+    resetRenderStats();
+
+    std::thread t1([](){ addRenderStat(CUBE_TESTS, 3); });
+    std::thread t2([](){ addRenderStat(CUBE_TESTS, 2); });
+    t1.join();
+    t2.join();
+    addRenderStat(CUBE_TESTS);
+
+    EXPECT_EQ(collectRenderStats().getCounter(CUBE_TESTS), 6);
+}
+
+TEST(RenderStats_resetRenderStatsTest, CountersAndStagesAreZeroed){
+    addRenderStat(MATRIX_INVERSIONS, 7);
+    addStageTime(STAGE_TRACE, 1.5);
+
+    resetRenderStats();
+
+    RenderStats stats = collectRenderStats();
+    EXPECT_EQ(stats.getCounter(MATRIX_INVERSIONS), 0);
+    EXPECT_EQ(stats.getStageSeconds(STAGE_TRACE), 0);
+}
+
+TEST(RenderStats_reportTest, ReportListsEveryCounterAndStage){
+    resetRenderStats();
+    addRenderStat(REFRACTION_RAYS, 12);
+    addStageTime(STAGE_OUTPUT, 0.25);
+
+    std::string report = collectRenderStats().report();
+
+    for(int i = 0; i < RENDER_COUNTER_COUNT; i++){
+        EXPECT_NE(report.find(renderCounterName(static_cast<RenderCounter>(i))), std::string::npos);
+    }
+    for(int i = 0; i < RENDER_STAGE_COUNT; i++){
+        EXPECT_NE(report.find(renderStageName(static_cast<RenderStage>(i))), std::string::npos);
+    }
+    EXPECT_NE(report.find("12"), std::string::npos);
+    EXPECT_NE(report.find("0.250000 s"), std::string::npos);
+}
+
+TEST(RenderStats_StageTimerTest, TimeIsAddedWhenTimerIsDestroyed){
+    resetRenderStats();
+
+    {
+        StageTimer t(STAGE_BVH_BUILD);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    EXPECT_GT(collectRenderStats().getStageSeconds(STAGE_BVH_BUILD), 0);
+}
+
+// The render path is only instrumented when the library is compiled with -DRENDER_STATS
+TEST(RenderStats_renderTest, RenderCountsMatchTheScene){
+    World w = defaultWorld();
+    Camera c(11, 11, PI/2);
+    c.setTransform(viewTransformationMatrix(Point(0, 0, -5), Point(0, 0, 0), Vector(0, 1, 0)));
+    resetRenderStats();
+
+    c.renderParallel(w, 4);
+
+    RenderStats stats = collectRenderStats();
+    if(RENDER_STATS_ENABLED){
+        EXPECT_EQ(stats.getCounter(PRIMARY_RAYS), 121);
+        EXPECT_GT(stats.getCounter(SPHERE_TESTS), 0);
+        EXPECT_GT(stats.getCounter(PREPARE_LIGHT_DATA_CALLS), 0);
+        EXPECT_LE(stats.getCounter(SPHERE_HITS), stats.getCounter(SPHERE_TESTS));
+        EXPECT_GT(stats.getStageSeconds(STAGE_TRACE), 0);
+    }else{
+        EXPECT_EQ(stats.getCounter(PRIMARY_RAYS), 0);
+        EXPECT_EQ(stats.getCounter(SPHERE_TESTS), 0);
+    }
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "Scenes.h"
+
+TEST(ScenesTest, MainSceneMatchesMainRender){
+    Scene s = mainScene();
+
+    EXPECT_EQ(s.world.getObjects().size(), 3);
+    EXPECT_EQ(s.camera.getHSize(), 100);
+    EXPECT_EQ(s.camera.getVSize(), 50);
+}
+
+TEST(ScenesTest, DefaultSceneUsesDefaultWorld){
+    Scene s = defaultScene(20, 10);
+
+    EXPECT_EQ(s.world.getObjects().size(), defaultWorld().getObjects().size());
+    EXPECT_EQ(s.camera.getHSize(), 20);
+    EXPECT_EQ(s.camera.getVSize(), 10);
+}
+
+TEST(ScenesTest, GlassSceneHasNestedTransparentObjects){
+    Scene s = glassScene();
+
+    int transparent = 0;
+    for(Shape* object : s.world.getObjects()){
+        if(object->getMaterial().transparency > 0){
+            transparent++;
+        }
+    }
+    EXPECT_EQ(transparent, 2);
+}
+
+TEST(ScenesTest, StressSceneHasRequestedObjectsAndFloor){
+    EXPECT_EQ(stressScene(50).world.getObjects().size(), 51);
+    EXPECT_THROW(stressScene(0), std::invalid_argument);
+}
+
+TEST(ScenesTest, StressSceneCameraSeesObjects){
+    Scene s = stressScene(9, 11, 11);
+
+    Colour centre = s.world.colourAtHit(s.camera.rayToPixel(5, 5));
+    EXPECT_FALSE(centre.isEqual(Colour(0, 0, 0)));
+}
+
+// The scene deletes its shapes, which releases the materials they registered
+TEST(ScenesTest, SceneOwnsItsShapes){
+    int registered = materialRegistry().size();
+    {
+        Scene s = glassScene();
+        EXPECT_GT(materialRegistry().size(), registered);
+        Scene moved = std::move(s);
+        EXPECT_EQ(moved.world.getObjects().size(), 5);
+    }
+    EXPECT_EQ(materialRegistry().size(), registered);
+}
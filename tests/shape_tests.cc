@@ -505,4 +505,193 @@ TEST(Shape_ComputeNormalTest, NormalCorrectForChildShape){
     Vector n = s->computeNormal(Point(1.7321, 1.1547, -5.5774));
 
     EXPECT_TRUE(n.isEqual(Vector(0.2857, 0.4286, -0.8571)));
-}
\ No newline at end of file
+}
+
+TEST(Shape_setTransformTest, InverseAndInverseTransposeUpdated){
+    Shape s;
+    EXPECT_TRUE(s.getInverseTransform().isEqual(Matrix(4)));
+    EXPECT_TRUE(s.getInverseTranspose().isEqual(Matrix(4)));
+
+    s.setTransform(translationMatrix(2, 3, 4));
+    s.setTransform(shearingMatrix(1, 0, 0, 0, 0, 0)*translationMatrix(2, 3, 4));
+
+    Matrix4 expected = (shearingMatrix(1, 0, 0, 0, 0, 0)*translationMatrix(2, 3, 4)).inverse();
+    EXPECT_TRUE(s.getInverseTransform().isEqual(expected));
+    EXPECT_TRUE(s.getInverseTranspose().isEqual(expected.transpose()));
+}
+
+TEST(Shape_WorldToObjectTest, ParentTransformChangeIsApplied){
+    Group* g = new Group;
+    g->setTransform(scalingMatrix(2, 2, 2));
+    Sphere* s = new Sphere;
+    g->appendShape(s);
+
+    // Changing the parent transform after the child was added must be reflected
+    g->setTransform(translationMatrix(0, 0, 5));
+    Point p = s->worldToObject(Point(0, 0, 4));
+
+    EXPECT_TRUE(p.isEqual(Point(0, 0, -1)));
+}
+
+TEST(Shape_commitTransformsTest, NestedGroupsAreFlattenedIntoPrimitives){
+    Group* g1 = new Group;
+    g1->setTransform(yRotationMatrix(PI/2));
+    Group* g2 = new Group;
+    g2->setTransform(scalingMatrix(1, 2, 3));
+    g1->appendShape(g2);
+    Sphere* s = new Sphere;
+    s->setTransform(translationMatrix(5, 0, 0));
+    g2->appendShape(s);
+    Cube* c = new Cube;
+    g1->appendShape(c);
+    EXPECT_FALSE(s->isWorldCommitted());
+
+    std::vector<Shape*> primitives;
+    g1->commitTransforms(Matrix4(), Matrix4(), primitives);
+
+    ASSERT_EQ(primitives.size(), 2);
+    EXPECT_EQ(primitives.at(0), s);
+    EXPECT_EQ(primitives.at(1), c);
+    EXPECT_TRUE(s->isWorldCommitted());
+    Matrix4 world = yRotationMatrix(PI/2)*scalingMatrix(1, 2, 3)*translationMatrix(5, 0, 0);
+    EXPECT_TRUE(s->getWorldTransform().isEqual(world));
+    EXPECT_TRUE(s->getWorldInverse().isEqual(world.inverse()));
+
+    // Same normal as walking up the groups
+    Vector n = s->computeNormal(Point(1.7321, 1.1547, -5.5774));
+    EXPECT_TRUE(n.isEqual(Vector(0.2857, 0.4286, -0.8571)));
+
+    // Transforming a shape inside a group leaves it uncommitted until the next commit
+    s->setTransform(translationMatrix(4, 0, 0));
+    EXPECT_FALSE(s->isWorldCommitted());
+    delete g1;
+    delete g2;
+    delete s;
+    delete c;
+}
+
+// Transforming a group after a commit invalidates every shape below it, so normals walk the groups again
+TEST(Shape_commitTransformsTest, TransformingGroupInvalidatesDescendants){
+    Group* g = new Group;
+    Group* inner = new Group;
+    g->appendShape(inner);
+    Sphere* s = new Sphere;
+    inner->appendShape(s);
+    std::vector<Shape*> primitives;
+    g->commitTransforms(Matrix4(), Matrix4(), primitives);
+    EXPECT_TRUE(s->isWorldCommitted());
+
+    g->setTransform(scalingMatrix(1, 0.5, 1));
+    EXPECT_TRUE(g->isWorldCommitted());
+    EXPECT_FALSE(inner->isWorldCommitted());
+    EXPECT_FALSE(s->isWorldCommitted());
+    Point p(sqrt(0.5), 0.5*sqrt(0.5), 0);
+    EXPECT_TRUE(s->computeNormal(p).isEqual(s->normalToWorld(s->childNormal(s->worldToObject(p)))));
+    EXPECT_TRUE(s->computeNormal(p).isEqual(Vector(0.4472, 0.8944, 0)));
+
+    // Adding a committed group to another group invalidates the shapes below it as well
+    primitives.clear();
+    g->commitTransforms(Matrix4(), Matrix4(), primitives);
+    EXPECT_TRUE(s->isWorldCommitted());
+    Group* outer = new Group;
+    outer->setTransform(translationMatrix(1, 0, 0));
+    outer->appendShape(g);
+    EXPECT_FALSE(s->isWorldCommitted());
+    EXPECT_TRUE(s->computeNormal(Point(1 + sqrt(0.5), 0.5*sqrt(0.5), 0)).isEqual(Vector(0.4472, 0.8944, 0)));
+    delete outer;
+    delete g;
+    delete inner;
+    delete s;
+}
+
+TEST(Shape_findWorldIntersectionsTest, CommittedPrimitiveMatchesGroupIntersections){
+    Group* g1 = new Group;
+    g1->setTransform(translationMatrix(0, 0, 3));
+    Group* g2 = new Group;
+    g2->setTransform(scalingMatrix(2, 2, 2));
+    g1->appendShape(g2);
+    Sphere* s = new Sphere;
+    s->setTransform(translationMatrix(0.5, 0, 0));
+    g2->appendShape(s);
+    Ray r(Point(1, 0.5, -10), Vector(0, 0, 1));
+
+    std::vector<Intersection> expected = g1->findIntersections(r);
+    std::vector<Shape*> primitives;
+    g1->commitTransforms(Matrix4(), Matrix4(), primitives);
+    std::vector<Intersection> result;
+    s->findWorldIntersections(r, result);
+
+    ASSERT_EQ(expected.size(), 2);
+    ASSERT_EQ(result.size(), expected.size());
+    for(int i = 0; i < result.size(); i++){
+        EXPECT_TRUE(result.at(i).isEqual(expected.at(i)));
+    }
+
+    float tMax = INFINITY;
+    Intersection hit(INFINITY, nullptr);
+    EXPECT_TRUE(s->closestWorldIntersection(r, 0, tMax, hit));
+    EXPECT_TRUE(hit.isEqual(expected.at(0)));
+    EXPECT_TRUE(s->worldOccludes(r, 0, INFINITY));
+    delete g1;
+    delete g2;
+    delete s;
+}
+
+// The kernels only append the intersections in [tMin, tMax), and skip the rest of the work once none can be
+TEST(Shape_childIntersectionsTest, KernelsOnlyAppendIntersectionsInRange){
+    Ray r(Point(0, 0, -5), Vector(0, 0, 1));
+    Sphere sphere;
+    std::vector<Intersection> result;
+    sphere.childIntersections(r, result, 0, 5);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result.at(0).getTime(), 4);
+    result.clear();
+    sphere.childIntersections(r, result, 4, 6);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result.at(0).getTime(), 4);
+    result.clear();
+    sphere.childIntersections(r, result, 0, 4);
+    EXPECT_TRUE(result.empty());
+
+    Cube cube;
+    result.clear();
+    cube.childIntersections(r, result, 4.5, 10);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result.at(0).getTime(), 6);
+    result.clear();
+    cube.childIntersections(r, result, 6.5, 10);
+    EXPECT_TRUE(result.empty());
+
+    Plane plane;
+    Ray down(Point(0, 1, 0), Vector(0, -1, 0));
+    result.clear();
+    plane.childIntersections(down, result, 0, 1);
+    EXPECT_TRUE(result.empty());
+    plane.childIntersections(down, result, 0, 2);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result.at(0).getTime(), 1);
+
+    // The walls of the cylinder are out of range but a cap is not
+    Cylinder cylinder;
+    cylinder.setMaxH(2);
+    cylinder.setMinH(1);
+    cylinder.setClosed(true);
+    result.clear();
+    cylinder.childIntersections(Ray(Point(0, 3, 0), Vector(0, -1, 0)), result, 0, 1.5);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result.at(0).getTime(), 1);
+    result.clear();
+    cylinder.childIntersections(Ray(Point(0, 1.5, -5), Vector(0, 0, 1)), result, 0, 4);
+    EXPECT_TRUE(result.empty());
+
+    Cone cone;
+    result.clear();
+    cone.childIntersections(Ray(Point(1, 1, -5), Vector(-0.5, -1, 1).normalize()), result, 10, INFINITY);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_TRUE(floatIsEqual(result.at(0).getTime(), 49.44994));
+
+    // Without a range every intersection is appended
+    result.clear();
+    sphere.childIntersections(r, result);
+    EXPECT_EQ(result.size(), 2);
+}
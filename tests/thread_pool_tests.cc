@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "ThreadPool.h"
+#include <vector>
+#include <stdexcept>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+TEST(ThreadPoolTest, ThreadCountBelowOneUsesHardwareThreads){
+    ThreadPool pool(0);
+
+    EXPECT_GE(pool.getThreadCount(), 1);
+    EXPECT_EQ(ThreadPool(3).getThreadCount(), 3);
+}
+
+TEST(ThreadPool_parallelForTest, EveryTaskRunsExactlyOnce){
+    ThreadPool pool(4);
+    std::vector<int> counts(1000, 0);
+
+    pool.parallelFor(counts.size(), [&](int i){
+        counts.at(i)++;
+    });
+
+    for(int i = 0; i < counts.size(); i++){
+        EXPECT_EQ(counts.at(i), 1);
+    }
+}
+
+TEST(ThreadPool_parallelForTest, TaskExceptionIsRethrown){
+    ThreadPool pool(4);
+
+    EXPECT_THROW(pool.parallelFor(100, [](int i){
+        if(i == 42){
+            throw std::invalid_argument("task failed");
+        }
+    }), std::invalid_argument);
+}
+
+// The workers are started once, so thread local state set by one call is still there in the next
+TEST(ThreadPool_parallelForTest, WorkersAreKeptBetweenCalls){
+    static thread_local bool ranBefore = false;
+    ThreadPool pool(4);
+    pool.parallelFor(100, [](int i){
+        ranBefore = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+
+    std::atomic<int> newThreads(0);
+    for(int call = 0; call < 5; call++){
+        pool.parallelFor(100, [&](int i){
+            if(!ranBefore){
+                newThreads++;
+            }
+        });
+    }
+    EXPECT_EQ(newThreads, 0);
+}
+
+TEST(ThreadPool_parallelForTest, NestedCallRunsOnCallingThread){
+    ThreadPool pool(4);
+    std::vector<int> counts(100, 0);
+
+    pool.parallelFor(10, [&](int i){
+        pool.parallelFor(10, [&](int j){
+            counts.at(i*10 + j)++;
+        });
+    });
+
+    for(int i = 0; i < counts.size(); i++){
+        EXPECT_EQ(counts.at(i), 1);
+    }
+}
+
+// Calls from several threads on the shared pool run one after the other
+TEST(sharedThreadPoolTest, SharedByCallersOnSeveralThreads){
+    EXPECT_EQ(&sharedThreadPool(3), &sharedThreadPool(3));
+    EXPECT_EQ(sharedThreadPool(3).getThreadCount(), 3);
+    EXPECT_EQ(&sharedThreadPool(0), &sharedThreadPool(-1));
+
+    std::vector<std::atomic<int>> counts(4000);
+    std::vector<std::thread> callers;
+    for(int c = 0; c < 4; c++){
+        callers.push_back(std::thread([&, c](){
+            sharedThreadPool(3).parallelFor(1000, [&](int i){
+                counts.at(c*1000 + i)++;
+            });
+        }));
+    }
+    for(int c = 0; c < callers.size(); c++){
+        callers.at(c).join();
+    }
+
+    for(int i = 0; i < counts.size(); i++){
+        EXPECT_EQ(counts.at(i), 1);
+    }
+}
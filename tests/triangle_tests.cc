@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+#include "Triangle.h"
+#include "Shape.h"
+#include "Group.h"
+#include "World.h"
+#include "LightData.h"
+#include "Matrix.h"
+#include "common.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Triangle used by most of the tests below
+static Triangle bookTriangle(){
+    return Triangle(Point(0, 1, 0), Point(-1, 0, 0), Point(1, 0, 0));
+}
+
+// Grid of side x side squares over [-1, 1] x [-1, 1] split into two triangles each, with the height of every
+// vertex varied so the triangles aren't in one plane
+static TriangleMesh gridMesh(int side){
+    std::vector<Point> vertices;
+    for(int y = 0; y <= side; y++){
+        for(int x = 0; x <= side; x++){
+            float px = -1 + 2.0*x/side;
+            float py = -1 + 2.0*y/side;
+            vertices.push_back(Point(px, py, 0.2*sin(3*px)*cos(2*py)));
+        }
+    }
+    std::vector<uint32_t> indices;
+    for(int y = 0; y < side; y++){
+        for(int x = 0; x < side; x++){
+            uint32_t a = y*(side + 1) + x;
+            uint32_t b = a + 1;
+            uint32_t c = a + side + 1;
+            uint32_t d = c + 1;
+            indices.insert(indices.end(), {a, b, d, a, d, c});
+        }
+    }
+    return TriangleMesh(vertices, indices);
+}
+
+// Times of the ray hitting each triangle of the mesh separately
+static std::vector<float> bruteForceTimes(const TriangleMesh &mesh, const Ray &r){
+    std::vector<float> times;
+    WatertightRay wr(r);
+    const std::vector<Point> &v = mesh.getVertices();
+    const std::vector<uint32_t> &idx = mesh.getIndices();
+    for(int i = 0; i < mesh.getTriangleCount(); i++){
+        float t;
+        if(intersectTriangle(wr, v.at(idx.at(3*i)), v.at(idx.at(3*i + 1)), v.at(idx.at(3*i + 2)), t)){
+            times.push_back(t);
+        }
+    }
+    std::sort(times.begin(), times.end());
+    return times;
+}
+
+TEST(TriangleTest, ConstructingATriangle){
+    Triangle t = bookTriangle();
+    EXPECT_TRUE(t.getP1().isEqual(Point(0, 1, 0)));
+    EXPECT_TRUE(t.getP2().isEqual(Point(-1, 0, 0)));
+    EXPECT_TRUE(t.getP3().isEqual(Point(1, 0, 0)));
+    EXPECT_TRUE(t.getE1().isEqual(Vector(-1, -1, 0)));
+    EXPECT_TRUE(t.getE2().isEqual(Vector(1, -1, 0)));
+    EXPECT_TRUE(t.getNormal().isEqual(Vector(0, 0, -1)));
+}
+
+TEST(Triangle_childNormalTest, NormalIsTheSameEverywhere){
+    Triangle t = bookTriangle();
+    EXPECT_TRUE(t.childNormal(Point(0, 0.5, 0)).isEqual(t.getNormal()));
+    EXPECT_TRUE(t.childNormal(Point(-0.5, 0.75, 0)).isEqual(t.getNormal()));
+    EXPECT_TRUE(t.childNormal(Point(0.5, 0.25, 0)).isEqual(t.getNormal()));
+}
+
+TEST(Triangle_childIntersectionsTest, RayParallelToTriangleMisses){
+    Triangle t = bookTriangle();
+    EXPECT_EQ(t.childIntersections(Ray(Point(0, -1, -2), Vector(0, 1, 0))).size(), 0);
+}
+
+TEST(Triangle_childIntersectionsTest, RayMissesEachEdge){
+    Triangle t = bookTriangle();
+    EXPECT_EQ(t.childIntersections(Ray(Point(1, 1, -2), Vector(0, 0, 1))).size(), 0);
+    EXPECT_EQ(t.childIntersections(Ray(Point(-1, 1, -2), Vector(0, 0, 1))).size(), 0);
+    EXPECT_EQ(t.childIntersections(Ray(Point(0, -1, -2), Vector(0, 0, 1))).size(), 0);
+}
+
+TEST(Triangle_childIntersectionsTest, RayStrikesTriangleFromEitherSide){
+    Triangle t = bookTriangle();
+    std::vector<Intersection> front = t.childIntersections(Ray(Point(0, 0.5, -2), Vector(0, 0, 1)));
+    ASSERT_EQ(front.size(), 1);
+    EXPECT_TRUE(floatIsEqual(front.at(0).getTime(), 2));
+    EXPECT_EQ(front.at(0).getShape(), &t);
+
+    std::vector<Intersection> back = t.childIntersections(Ray(Point(0.2, 0.3, 4), Vector(0, 0, -2)));
+    ASSERT_EQ(back.size(), 1);
+    EXPECT_TRUE(floatIsEqual(back.at(0).getTime(), 2));
+}
+
+TEST(Triangle_childBoundsTest, BoundsContainVertices){
+    Triangle t(Point(-3, 7, 2), Point(6, 2, -4), Point(2, -1, -1));
+    BoundingBox b = t.childBounds();
+    EXPECT_TRUE(b.getMin().isEqual(Point(-3, -1, -4)));
+    EXPECT_TRUE(b.getMax().isEqual(Point(6, 7, 2)));
+}
+
+// Rays through points exactly on an edge or vertex shared by several triangles must hit at least one of them
+TEST(intersectTriangleTest, SharedEdgesAndVerticesAreWatertight){
+    Point centre(0.1, 0.3, 0.7);
+    std::vector<Point> ring;
+    for(int i = 0; i < 7; i++){
+        ring.push_back(Point(centre.x + cos(0.9*i), centre.y + sin(0.9*i), centre.z + 0.1*i));
+    }
+
+    std::vector<Vector> directions({Vector(0, 0, 1), Vector(0.3, -0.2, 1).normalize(), Vector(-1, 0.7, 0.4).normalize()});
+    for(int d = 0; d < directions.size(); d++){
+        WatertightRay wr(Ray(Point(centre - directions.at(d)*5), directions.at(d)));
+        int hits = 0;
+        for(int i = 0; i + 1 < ring.size(); i++){
+            float t;
+            hits += intersectTriangle(wr, centre, ring.at(i), ring.at(i + 1), t);
+        }
+        EXPECT_GE(hits, 1);
+    }
+
+    // Points along the shared diagonal of two triangles making up a square
+    Point a(-1, -1, 0), b(1, -1, 0), c(1, 1, 0), d(-1, 1, 0);
+    for(int i = 0; i <= 40; i++){
+        float s = -1 + i/20.0;
+        Vector dir = Vector(0.13, 0.29, 1).normalize();
+        WatertightRay wr(Ray(Point(Point(s, s, 0) - dir*3), dir));
+        float t;
+        int hits = intersectTriangle(wr, a, b, c, t) + intersectTriangle(wr, a, c, d, t);
+        EXPECT_GE(hits, 1) << "s = " << s;
+    }
+}
+
+TEST(TriangleMeshTest, InvalidIndicesThrow){
+    std::vector<Point> vertices({Point(0, 1, 0), Point(-1, 0, 0), Point(1, 0, 0)});
+    EXPECT_THROW(TriangleMesh(vertices, {0, 1}), std::invalid_argument);
+    EXPECT_THROW(TriangleMesh(vertices, {0, 1, 3}), std::invalid_argument);
+    EXPECT_NO_THROW(TriangleMesh(vertices, {}));
+}
+
+TEST(TriangleMeshTest, EdgesAndNormalsArePrecomputed){
+    TriangleMesh mesh({Point(0, 1, 0), Point(-1, 0, 0), Point(1, 0, 0), Point(0, -1, 0)}, {0, 1, 2, 1, 3, 2});
+    Triangle t = bookTriangle();
+    ASSERT_EQ(mesh.getTriangleCount(), 2);
+    EXPECT_TRUE(mesh.getE1(0).isEqual(t.getE1()));
+    EXPECT_TRUE(mesh.getE2(0).isEqual(t.getE2()));
+    EXPECT_TRUE(mesh.getNormal(0).isEqual(t.getNormal()));
+    EXPECT_TRUE(mesh.getNormal(1).isEqual(Vector(0, 0, -1)));
+}
+
+// The mesh's BVH finds the same intersections as testing every triangle
+TEST(TriangleMesh_childIntersectionsTest, MatchesTestingEveryTriangle){
+    TriangleMesh mesh = gridMesh(12);
+    ASSERT_EQ(mesh.getTriangleCount(), 288);
+    EXPECT_GT(mesh.getNodeCount(), 1);
+
+    for(int i = 0; i < 50; i++){
+        Point origin(-1.5 + 0.061*i, 1.3 - 0.047*i, -3);
+        Vector dir = Vector(0.02*(i % 7) - 0.06, 0.015*(i % 5) - 0.03, 1).normalize();
+        Ray r(origin, dir);
+        std::vector<float> expected = bruteForceTimes(mesh, r);
+
+        std::vector<Intersection> intersects = mesh.childIntersections(r);
+        std::vector<float> result;
+        for(int j = 0; j < intersects.size(); j++){
+            EXPECT_EQ(intersects.at(j).getShape(), &mesh);
+            result.push_back(intersects.at(j).getTime());
+        }
+        std::sort(result.begin(), result.end());
+
+        ASSERT_EQ(result.size(), expected.size());
+        for(int j = 0; j < result.size(); j++){
+            EXPECT_TRUE(floatIsEqual(result.at(j), expected.at(j)));
+        }
+    }
+}
+
+// The closest hit records which triangle was hit and the normal is read from that triangle
+TEST(TriangleMesh_closestIntersectionTest, RecordsTriangleIndex){
+    TriangleMesh mesh({Point(0, 1, 0), Point(-1, 0, 0), Point(1, 0, 0), Point(0, 1, 2), Point(-1, 0, 2), Point(1, 0, 1)},
+        {0, 1, 2, 3, 4, 5});
+    Ray r(Point(0, 0.5, -2), Vector(0, 0, 1));
+    float tMax = INFINITY;
+    Intersection hit(INFINITY, nullptr);
+    ASSERT_TRUE(mesh.closestIntersection(r, 0, tMax, hit));
+    EXPECT_TRUE(floatIsEqual(hit.getTime(), 2));
+    EXPECT_EQ(hit.getShape(), &mesh);
+    EXPECT_EQ(hit.getIndex(), 0);
+
+    // Starting past the first triangle finds the second
+    tMax = INFINITY;
+    ASSERT_TRUE(mesh.closestIntersection(r, 2.5, tMax, hit));
+    EXPECT_EQ(hit.getIndex(), 1);
+    EXPECT_TRUE(mesh.computeNormal(r.computePosition(hit.getTime()), hit).isEqual(mesh.getNormal(1)));
+
+    EXPECT_TRUE(mesh.occludes(r, 0, INFINITY));
+    EXPECT_FALSE(mesh.occludes(r, 0, 1.5));
+}
+
+// Rays through the grid's vertices and along its edges have an edge function of exactly 0 in the leaf kernel,
+// they still hit the mesh
+TEST(TriangleMesh_closestIntersectionTest, SharedEdgesAndVerticesAreWatertight){
+    TriangleMesh mesh = gridMesh(8);
+    for(int i = 0; i <= 32; i++){
+        float s = -1 + i/16.0;
+        std::vector<Point> points({Point(s, s, -3), Point(s, 0.25, -3), Point(-0.5, s, -3)});
+        for(int j = 0; j < points.size(); j++){
+            Ray r(points.at(j), Vector(0, 0, 1));
+            float tMax = INFINITY;
+            Intersection hit(INFINITY, nullptr);
+            EXPECT_TRUE(mesh.closestIntersection(r, 0, tMax, hit)) << "s = " << s << ", j = " << j;
+            EXPECT_TRUE(mesh.occludes(r, 0, INFINITY)) << "s = " << s << ", j = " << j;
+            EXPECT_FALSE(mesh.childIntersections(r).empty()) << "s = " << s << ", j = " << j;
+        }
+    }
+}
+
+TEST(TriangleMesh_childNormalTest, FindsTriangleContainingPoint){
+    TriangleMesh mesh({Point(0, 0, 0), Point(1, 0, 0), Point(0, 1, 0), Point(0, 0, 1)}, {0, 1, 2, 0, 3, 1});
+    EXPECT_TRUE(mesh.childNormal(Point(0.2, 0.2, 0)).isEqual(mesh.getNormal(0)));
+    EXPECT_TRUE(mesh.childNormal(Point(0.2, 0, 0.2)).isEqual(mesh.getNormal(1)));
+}
+
+// A transformed mesh inside a group is committed into the world's BVH like any other shape
+TEST(TriangleMesh_WorldTest, MeshInGroupIsRendered){
+    TriangleMesh* mesh = new TriangleMesh(gridMesh(6));
+    mesh->setTransform(scalingMatrix(2, 2, 2));
+    Material m;
+    m.colour = Colour(0.2, 0.8, 0.3);
+    mesh->setMaterial(m);
+    Group* g = new Group;
+    g->setTransform(translationMatrix(0, 0, 5));
+    g->appendShape(mesh);
+
+    World w;
+    w.setLight(LightSource(Point(-10, 10, -10), Colour(1, 1, 1)));
+    w.appendObject(g);
+    w.buildBVH();
+    ASSERT_EQ(w.getPrimitives().size(), 1);
+
+    Ray r(Point(0.3, -0.4, -5), Vector(0, 0, 1));
+    Intersection hit(INFINITY, nullptr);
+    ASSERT_TRUE(w.closestHit(r, hit));
+    EXPECT_EQ(hit.getShape(), mesh);
+    ASSERT_GE(hit.getIndex(), 0);
+    std::vector<float> expected = bruteForceTimes(*mesh, Ray(Point(0.15, -0.2, -5), Vector(0, 0, 0.5)));
+    ASSERT_EQ(expected.size(), 1);
+    EXPECT_TRUE(floatIsEqual(hit.getTime(), expected.at(0)));
+
+    LightData data = prepareLightData(hit, r);
+    EXPECT_TRUE(data.normal.isEqual(mesh->normalToWorld(mesh->getNormal(hit.getIndex()))) ||
+        data.normal.isEqual(mesh->normalToWorld(mesh->getNormal(hit.getIndex())).negateTuple()));
+
+    Colour c = w.colourAtHit(r);
+    EXPECT_FALSE(c.isEqual(Colour(0, 0, 0)));
+}
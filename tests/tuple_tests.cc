@@ -120,4 +120,25 @@ TEST(VectorOperations, VectorCrossProduct){
   Vector b(2, 3, 4);
   EXPECT_TRUE(crossProduct(a, b).isEqual(Vector(-1, 2, -1)));
   EXPECT_TRUE(crossProduct(b, a).isEqual(Vector(1, -2, 1)));
-}
\ No newline at end of file
+}
+TEST(TupleSIMDTest, TupleIsAlignedAndPacked){
+  Point points[3];
+
+  EXPECT_EQ(sizeof(Tuple), 16);
+  EXPECT_EQ(alignof(Tuple), 16);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(&points[1]) % 16, 0);
+}
+
+TEST(TupleSIMDTest, OperationsKeepPointAndVectorDistinction){
+  Point p(1, 2, 3);
+  Vector v(-2, 4, 0.5);
+
+  EXPECT_TRUE((p + v).isEqual(Tuple(-1, 6, 3.5, 1)));
+  EXPECT_TRUE((p - p).isEqual(Tuple(0, 0, 0, 0)));
+  EXPECT_TRUE((v*2).isEqual(Tuple(-4, 8, 1, 0)));
+  EXPECT_TRUE((v/2).isEqual(Tuple(-1, 2, 0.25, 0)));
+  EXPECT_TRUE(v.negateTuple().isEqual(Tuple(2, -4, -0.5, 0)));
+  EXPECT_TRUE(Vector(3, 0, 4).normalize().isEqual(Vector(0.6, 0, 0.8)));
+  EXPECT_TRUE(crossProduct(v, Vector(1, 1, 1)).isEqual(Vector(3.5, 2.5, -6)));
+  EXPECT_NEAR(dotProduct(v, Vector(1, 1, 1)), 2.5, EPSILON);
+}
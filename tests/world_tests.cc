@@ -370,4 +370,55 @@ TEST(WorldTest, ShadeHitUsesReflectanceWhenCombiningReflectionAndRefraction){
 
     Colour c = w.shadeHit(data, 5);
     EXPECT_TRUE(c.isEqual(Colour(0.93391, 0.69643, 0.69243)));
-}
\ No newline at end of file
+}
+
+TEST(World_closestHitTest, FindsNearestNonNegativeHit){
+    World w = defaultWorld();
+    Intersection hit(INFINITY, nullptr);
+
+    bool found = w.closestHit(Ray(Point(0, 0, -5), Vector(0, 0, 1)), hit);
+    EXPECT_TRUE(found);
+    EXPECT_EQ(hit.getTime(), 4);
+    EXPECT_EQ(hit.getShape(), w.getObjects().at(0));
+
+    // Ray starts inside both spheres, hits behind the origin are ignored
+    found = w.closestHit(Ray(Point(0, 0, 0), Vector(0, 0, 1)), hit);
+    EXPECT_TRUE(found);
+    EXPECT_EQ(hit.getTime(), 0.5);
+    EXPECT_EQ(hit.getShape(), w.getObjects().at(1));
+
+    found = w.closestHit(Ray(Point(0, 0, -5), Vector(0, 1, 0)), hit);
+    EXPECT_FALSE(found);
+}
+
+TEST(World_closestHitTest, HitsBeyondTMaxAreRejected){
+    World w = defaultWorld();
+    w.buildBVH();
+    Intersection hit(INFINITY, nullptr);
+
+    EXPECT_FALSE(w.closestHit(Ray(Point(0, 0, -5), Vector(0, 0, 1)), hit, 0, 3.5));
+    EXPECT_TRUE(w.closestHit(Ray(Point(0, 0, -5), Vector(0, 0, 1)), hit, 4.2, INFINITY));
+    EXPECT_EQ(hit.getTime(), 4.5);
+}
+
+TEST(World_hasShadowTest, OccludersThatDontCastShadowsAreIgnored){
+    World w = defaultWorld();
+    Point p(10, -10, 10);
+    Material m;
+    m.castsShadow = false;
+
+    w.getObjects().at(0)->setMaterial(m);
+    w.getObjects().at(1)->setMaterial(m);
+
+    EXPECT_FALSE(w.hasShadow(p));
+}
+
+TEST(World_hasShadowTest, BVHGivesSameResult){
+    World w = defaultWorld();
+    w.buildBVH();
+
+    EXPECT_FALSE(w.hasShadow(Point(0, 10, 0)));
+    EXPECT_TRUE(w.hasShadow(Point(10, -10, 10)));
+    EXPECT_FALSE(w.hasShadow(Point(-20, 20, -20)));
+    EXPECT_FALSE(w.hasShadow(Point(-2, 2, -2)));
+}